@@ -0,0 +1,104 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <stdint.h>
+
+#if defined(USE_PEXT)
+#if !defined(__BMI2__)
+#error "USE_PEXT requires a BMI2 target (build with -mbmi2)"
+#endif
+#include <immintrin.h>
+#endif
+
+typedef uint64_t Bitboard;
+
+#define BB_EMPTY      0ULL
+#define BB_SQUARE(sq) (1ULL << (sq))
+
+#define BB_FILE_A 0x0101010101010101ULL
+#define BB_FILE_H (BB_FILE_A << 7)
+#define BB_RANK_1 0x00000000000000FFULL
+#define BB_RANK_2 (BB_RANK_1 << 8)
+#define BB_RANK_3 (BB_RANK_1 << 16)
+#define BB_RANK_6 (BB_RANK_1 << 40)
+#define BB_RANK_7 (BB_RANK_1 << 48)
+#define BB_RANK_8 (BB_RANK_1 << 56)
+
+enum {
+    DIR_NORTH = 0,
+    DIR_EAST,
+    DIR_NORTH_EAST,
+    DIR_NORTH_WEST,
+    DIR_SOUTH,
+    DIR_WEST,
+    DIR_SOUTH_WEST,
+    DIR_SOUTH_EAST,
+    DIR_COUNT
+};
+
+static inline int bb_popcount(Bitboard b) { return __builtin_popcountll(b); }
+static inline int bb_lsb(Bitboard b) { return __builtin_ctzll(b); }
+static inline int bb_msb(Bitboard b) { return 63 - __builtin_clzll(b); }
+
+static inline int bb_pop_lsb(Bitboard *b)
+{
+    int sq = __builtin_ctzll(*b);
+    *b &= *b - 1;
+    return sq;
+}
+
+static inline Bitboard bb_shift(Bitboard b, int delta)
+{
+    return delta > 0 ? b << delta : b >> -delta;
+}
+
+typedef struct {
+    Bitboard mask;
+    Bitboard magic;
+    Bitboard *attacks;
+    unsigned shift;
+} Magic;
+
+extern Magic bb_rook_magics[64];
+extern Magic bb_bishop_magics[64];
+
+extern Bitboard bb_knight_attacks[64];
+extern Bitboard bb_king_attacks[64];
+extern Bitboard bb_pawn_attacks[2][64];
+extern Bitboard bb_rays[DIR_COUNT][64];
+extern Bitboard bb_between[64][64];
+extern Bitboard bb_line[64][64];
+
+void bitboard_init(void);
+const char *bitboard_slider_backend(void);
+
+Bitboard bb_rook_attacks_slow(int sq, Bitboard occ);
+Bitboard bb_bishop_attacks_slow(int sq, Bitboard occ);
+
+static inline unsigned magic_index(const Magic *m, Bitboard occ)
+{
+#if defined(USE_PEXT)
+    return (unsigned)_pext_u64(occ, m->mask);
+#else
+    return (unsigned)(((occ & m->mask) * m->magic) >> m->shift);
+#endif
+}
+
+static inline Bitboard bb_rook_attacks(int sq, Bitboard occ)
+{
+    const Magic *m = &bb_rook_magics[sq];
+    return m->attacks[magic_index(m, occ)];
+}
+
+static inline Bitboard bb_bishop_attacks(int sq, Bitboard occ)
+{
+    const Magic *m = &bb_bishop_magics[sq];
+    return m->attacks[magic_index(m, occ)];
+}
+
+static inline Bitboard bb_queen_attacks(int sq, Bitboard occ)
+{
+    return bb_rook_attacks(sq, occ) | bb_bishop_attacks(sq, occ);
+}
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef EPD_H
+#define EPD_H
+
+#include "position.h"
+#include <stddef.h>
+
+/* Streaming reader for files of FEN or EPD records, one per line. The file is
+ * memory-mapped and records are parsed in place with position_from_fen_n, so
+ * nothing is copied or NUL-terminated. Blank lines and lines starting with '#'
+ * are skipped. */
+typedef struct {
+    const char *data;
+    size_t size;
+    size_t offset;              /* start of the next unread line */
+    size_t line;                /* 1-based number of the last line read */
+    unsigned flags;             /* FEN_* flags passed to every parse; FEN_EPD is always added */
+    int mapped;
+} EpdReader;
+
+typedef struct {
+    const char *fen;            /* the position fields, inside the reader's buffer */
+    size_t fen_len;
+    const char *ops;            /* what follows them (EPD operations), trimmed; may be empty */
+    size_t ops_len;
+    size_t line;                /* 1-based line of the record */
+    size_t offset;              /* byte offset of the line in the file */
+    pos_error_t status;         /* POS_OK, or why the record did not parse */
+    size_t error_column;        /* 1-based column where parsing stopped, when status != POS_OK */
+} EpdRecord;
+
+pos_error_t epd_open(EpdReader *r, const char *path, unsigned flags, char *errbuf, size_t errbuf_size);
+
+/* Read from a caller-owned buffer instead of a file. */
+void epd_open_buffer(EpdReader *r, const char *data, size_t size, unsigned flags);
+
+void epd_close(EpdReader *r);
+
+/* Parse the next record into pos and rec. Returns 0 at end of input, otherwise
+ * 1 with rec->status telling whether pos is usable; on failure errbuf gets the
+ * line, column and reason, and the next call carries on with the following line. */
+int epd_next(EpdReader *r, Position *pos, EpdRecord *rec, char *errbuf, size_t errbuf_size);
+
+/* Operand of the first EPD operation named opcode in rec ("bm", "D5", ...),
+ * trimmed, or NULL if there is none. Semicolons inside quoted strings do not
+ * end an operation. */
+const char *epd_operand(const EpdRecord *rec, const char *opcode, size_t *len);
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef EVAL_H
+#define EVAL_H
+
+#include "position.h"
+#include "pawns.h"
+
+#define EVAL_PHASE_MAX 24
+
+extern const int eval_piece_value[7];
+
+/* Material + piece-square value of piece v (signed, as in Position.board) on sq,
+ * from white's point of view; index with v + 6. */
+extern int16_t eval_psq_mg[13][64];
+extern int16_t eval_psq_eg[13][64];
+
+/* Game-phase contribution per piece type; the starting position sums to EVAL_PHASE_MAX. */
+extern const uint8_t eval_phase_weight[7];
+
+static inline void eval_add_piece(Position *pos, int sq, int8_t v)
+{
+    pos->psq_mg += eval_psq_mg[v + 6][sq];
+    pos->psq_eg += eval_psq_eg[v + 6][sq];
+    pos->phase += eval_phase_weight[piece_abs(v)];
+}
+
+static inline void eval_remove_piece(Position *pos, int sq, int8_t v)
+{
+    pos->psq_mg -= eval_psq_mg[v + 6][sq];
+    pos->psq_eg -= eval_psq_eg[v + 6][sq];
+    pos->phase -= eval_phase_weight[piece_abs(v)];
+}
+
+static inline void eval_move_piece(Position *pos, int from, int to, int8_t v)
+{
+    pos->psq_mg += eval_psq_mg[v + 6][to] - eval_psq_mg[v + 6][from];
+    pos->psq_eg += eval_psq_eg[v + 6][to] - eval_psq_eg[v + 6][from];
+}
+
+/* Recompute psq_mg, psq_eg and phase from the board. */
+void eval_refresh(Position *pos);
+
+/* Static evaluation in centipawns from the side to move's point of view: the
+ * loaded NNUE network if there is one (nnue.h), else the tapered tables plus
+ * pawn structure. Material and piece-square terms come from the incremental
+ * accumulators; pawn structure is looked up in pawns, or recomputed when it is NULL. */
+int evaluate_cached(const Position *pos, PawnTable *pawns);
+int evaluate(const Position *pos);
+
+#endif
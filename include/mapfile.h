@@ -0,0 +1,14 @@
+#ifndef MAPFILE_H
+#define MAPFILE_H
+
+#include "position.h"
+#include <stddef.h>
+
+/* Map path read-only, advised for a front-to-back scan. An empty file maps to
+ * *data == NULL, *size == 0. Errors read "cannot open|stat|map <path>". */
+pos_error_t map_file(const char *path, const void **data, size_t *size, char *errbuf, size_t errbuf_size);
+
+/* Release a mapping from map_file; a NULL data is ignored. */
+void unmap_file(const void *data, size_t size);
+
+#endif
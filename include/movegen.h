@@ -4,6 +4,37 @@
 #include "position.h"
 #include <stdint.h>
 
+/* Packed move: bits 0-5 from, 6-11 to, 12-13 promotion piece (knight..queen), 14-15 flag. */
+typedef uint16_t Move;
+
+#define MOVE_NONE ((Move)0)
+
+#define MOVE_FLAG_NORMAL     0
+#define MOVE_FLAG_PROMOTION  1
+#define MOVE_FLAG_EN_PASSANT 2
+#define MOVE_FLAG_CASTLING   3
+
+#define MOVELIST_CAPACITY 256
+
+typedef struct {
+    Move moves[MOVELIST_CAPACITY];
+    int count;
+} MoveList;
+
+static inline Move move_encode(int from, int to, int promotion, int flag)
+{
+    int promo_bits = promotion ? promotion - PIECE_KNIGHT : 0;
+    return (Move)(from | (to << 6) | (promo_bits << 12) | (flag << 14));
+}
+
+static inline int move_from(Move m) { return m & 63; }
+static inline int move_to(Move m) { return (m >> 6) & 63; }
+static inline int move_flag(Move m) { return m >> 14; }
+static inline int move_promotion(Move m)
+{
+    return move_flag(m) == MOVE_FLAG_PROMOTION ? ((m >> 12) & 3) + PIECE_KNIGHT : 0;
+}
+
 typedef struct {
     int from, to;
     int8_t moved_piece;
@@ -13,13 +44,85 @@ typedef struct {
     uint16_t prev_halfmove;
     uint32_t prev_fullmove;
     int ep_capture_sq;
+    Move move;
+    uint64_t prev_hash;
+    uint64_t prev_pawn_key;
 } MoveUndo;
 
 uint64_t perft(Position *pos, int depth);
 
+int generate_legal_list(const Position *pos, MoveList *list);
+int generate_tactical_list(const Position *pos, MoveList *list);
+int generate_quiet_list(const Position *pos, MoveList *list);
+int move_is_legal(const Position *pos, Move m);
+int count_legal_moves(const Position *pos);
+int position_in_check(const Position *pos);
+int is_square_attacked(const Position *pos, int sq, int by);
+int see(const Position *pos, Move m);
+Move move_from_squares(const Position *pos, int from, int to, int promotion);
+void make_move_packed(Position *pos, Move move, MoveUndo *undo);
+
+/* Move notation (src/notation.c). Buffers must hold MOVE_UCI_MAX / MOVE_SAN_MAX
+ * bytes; the formatters return the length written, without the NUL. */
+#define MOVE_UCI_MAX 6          /* "e7e8q" */
+#define MOVE_SAN_MAX 10         /* "Qh4xe1+", "exd8=Q#" */
+
+/* Long algebraic as in UCI: "e2e4", "e7e8q", "e1g1" for castling, "0000" for MOVE_NONE. */
+int move_to_uci(Move m, char *buf);
+
+/* Parse long algebraic text[0..len) to a legal move of pos, or MOVE_NONE. */
+Move move_from_uci(const Position *pos, const char *text, size_t len);
+
+/* SAN of m in pos with minimal disambiguation and a '+' or '#' suffix, taken
+ * from one legal move generation; writes "" and returns 0 if m is not legal. */
+int move_to_san(const Position *pos, Move m, char *buf);
+
+/* Resolve the SAN move in san[0..len) ("Nbd7", "exd6", "e8=Q+", "O-O-O")
+ * against the legal moves of pos. Check, mate and !/? suffixes are ignored;
+ * returns MOVE_NONE for malformed, illegal or ambiguous moves. */
+Move move_from_san(const Position *pos, const char *san, size_t len);
+
+/*
+ * Staged move picker: the hash move (checked with move_is_legal, nothing generated),
+ * then captures and promotions that SEE does not lose, best MVV-LVA first, then the
+ * two killers, then quiet moves by history score, then the losing captures.
+ * Each stage is generated only when the previous one is exhausted.
+ * movepicker_init_tactical yields captures and promotions only.
+ */
+enum {
+    PICK_HASH,
+    PICK_GEN_CAPTURES,
+    PICK_GOOD_CAPTURES,
+    PICK_KILLER_1,
+    PICK_KILLER_2,
+    PICK_GEN_QUIETS,
+    PICK_QUIETS,
+    PICK_BAD_CAPTURES,
+    PICK_DONE
+};
+
+typedef struct {
+    const Position *pos;
+    const int32_t *history;    /* [from * 64 + to] for the side to move, or NULL */
+    Move hash_move;
+    Move killers[2];
+    int stage;
+    int tactical_only;
+    int index;
+    int bad_count;
+    MoveList list;
+    int scores[MOVELIST_CAPACITY];
+    Move bad_captures[MOVELIST_CAPACITY];
+} MovePicker;
+
+void movepicker_init(MovePicker *mp, const Position *pos, Move hash_move, const Move *killers,
+                     const int32_t *history);
+void movepicker_init_tactical(MovePicker *mp, const Position *pos, Move hash_move);
+Move movepicker_next(MovePicker *mp);
+
 int generate_legal_moves(Position *pos, int *moves_from, int *moves_to, int *promotions, int capacity);
 
 void make_move(Position *pos, int from, int to, int promotion, MoveUndo *undo);
 void unmake_move(Position *pos, const MoveUndo *undo);
 
-#endif 
+#endif
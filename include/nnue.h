@@ -0,0 +1,75 @@
+#ifndef NNUE_H
+#define NNUE_H
+
+#include "position.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * (768 -> NNUE_HIDDEN) x 2 -> 1 network. Each perspective sees the 12 piece
+ * kinds on 64 squares from its own side (black's view is rank-mirrored and
+ * colour-swapped), and the two clipped hidden layers feed a single output,
+ * side to move first.
+ */
+#define NNUE_INPUTS 768
+#define NNUE_QA     255     /* accumulator clip and feature-weight scale */
+#define NNUE_QB     64      /* output-weight scale */
+#define NNUE_SCALE  400     /* centipawns per unit of network output */
+
+/* Weights file: "NNUE", then little-endian u32 version (1), u32 inputs, u32 hidden,
+ * i16 feature_weights[inputs][hidden], i16 feature_bias[hidden],
+ * i16 output_weights[2][hidden], i32 output_bias. */
+#define NNUE_FILE_VERSION 1
+
+typedef struct {
+    _Alignas(32) int16_t feature_weights[NNUE_INPUTS][NNUE_HIDDEN];
+    _Alignas(32) int16_t feature_bias[NNUE_HIDDEN];
+    _Alignas(32) int16_t output_weights[2][NNUE_HIDDEN];
+    int32_t output_bias;
+} NNUENet;
+
+/* The loaded network, NULL while evaluate() uses the piece-square tables. */
+extern const NNUENet *nnue_net;
+
+/* Load a weights file and make it the active network. Positions attached
+ * before the call have stale accumulators; pass them through
+ * position_sync_bitboards. Must not be called while a search is running. */
+pos_error_t nnue_load(const char *path, char *errbuf, size_t errbuf_size);
+void nnue_unload(void);
+pos_error_t nnue_save(const NNUENet *net, const char *path, char *errbuf, size_t errbuf_size);
+
+/* "avx2", "sse2", "neon" or "scalar": the vector path compiled in. */
+const char *nnue_simd_backend(void);
+
+static inline int nnue_feature(int perspective, int8_t v, int sq)
+{
+    int color = v < 0;
+    if (perspective == COLOR_BLACK) {
+        color ^= 1;
+        sq ^= 56;
+    }
+    return (color * 6 + piece_abs(v) - 1) * 64 + sq;
+}
+
+/* Keep pos's accumulator incrementally in stack[0..]: make_move pushes a
+ * copy and updates it, unmake_move pops, so stack needs one entry per move
+ * the caller plays ahead. Copies of pos share the stack. Without a loaded
+ * network pos stays detached (pos->nnue == NULL). */
+void nnue_attach(Position *pos, NNUEAccumulator *stack);
+
+/* Accumulator updates mirroring the board edits in make_move, on pos->nnue. */
+void nnue_add_piece(Position *pos, int sq, int8_t v);
+void nnue_remove_piece(Position *pos, int sq, int8_t v);
+void nnue_move_piece(Position *pos, int from, int to, int8_t v);
+
+/* Sums for pos's board from scratch. */
+void nnue_accumulate(const Position *pos, NNUEAccumulator *acc);
+
+/* Rebuild pos->nnue from the board, if pos is attached. */
+void nnue_refresh(Position *pos);
+
+/* Network output in centipawns from the side to move's point of view; a
+ * detached position is accumulated from scratch. */
+int nnue_evaluate(const Position *pos);
+
+#endif
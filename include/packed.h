@@ -0,0 +1,52 @@
+#ifndef PACKED_H
+#define PACKED_H
+
+#include "position.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/* Fixed 32-byte binary encoding of a Position, independent of host byte order:
+ *   bytes  0..7   occupancy bitboard, little-endian
+ *   bytes  8..23  one nibble per occupied square in square order, low nibble
+ *                 first: piece type 1..6, plus 8 for black
+ *   byte  24      side to move (bit 0) and castling rights (bits 1..4)
+ *   byte  25      en-passant square, 0xFF for none
+ *   bytes 26..27  halfmove clock, little-endian
+ *   bytes 28..31  fullmove number, little-endian
+ * Records compare equal with memcmp exactly when the positions are equal. */
+#define PACKED_POSITION_SIZE 32
+#define PACKED_MAX_PIECES 32
+
+typedef struct {
+    uint8_t bytes[PACKED_POSITION_SIZE];
+} PackedPosition;
+
+/* Fails with POS_ERR_INVALID_ARG for more than PACKED_MAX_PIECES pieces. */
+pos_error_t position_pack(const Position *pos, PackedPosition *out);
+
+/* Rebuilds bitboards, keys and evaluation accumulators; flags takes
+ * FEN_NO_VALIDATE to skip position_validate. */
+pos_error_t position_unpack(Position *pos, const PackedPosition *in, unsigned flags,
+                            char *errbuf, size_t errbuf_size);
+
+/* File format: a 16-byte header ("CPOS", u16 version, u16 record size,
+ * u64 record count, all little-endian) followed by the records back to back. */
+#define PACKED_FILE_MAGIC "CPOS"
+#define PACKED_FILE_VERSION 1
+#define PACKED_FILE_HEADER_SIZE 16
+
+pos_error_t packed_file_write(const char *path, const Position *positions, size_t count,
+                              char *errbuf, size_t errbuf_size);
+
+/* A packed file mapped read-only; records point into the mapping. */
+typedef struct {
+    const PackedPosition *records;
+    size_t count;
+    const void *map;
+    size_t map_size;
+} PackedFile;
+
+pos_error_t packed_file_open(PackedFile *f, const char *path, char *errbuf, size_t errbuf_size);
+void packed_file_close(PackedFile *f);
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef PAWNS_H
+#define PAWNS_H
+
+#include "position.h"
+#include <stdint.h>
+
+#define PAWN_TABLE_ENTRIES 16384
+
+/* Pawn-structure terms for one pawn_key, white-relative. The king shields also
+ * depend on the king squares, so they are cached per colour alongside the
+ * square they were computed for and redone when the king has moved. */
+typedef struct {
+    uint64_t key;
+    int16_t mg, eg;
+    int8_t king_sq[2];          /* POS_NO_SQUARE = shield not computed yet */
+    int16_t shield[2];          /* middlegame only, from each colour's own point of view */
+} PawnEntry;
+
+/* Per search thread, so entries are written without synchronisation. */
+typedef struct {
+    PawnEntry entries[PAWN_TABLE_ENTRIES];
+    uint64_t probes, hits;
+} PawnTable;
+
+void pawn_table_clear(PawnTable *pt);
+
+/* Add the doubled, isolated, backward and passed pawn terms and the king
+ * shields of pos to *mg and *eg (white-relative). pt may be NULL to compute
+ * everything from scratch; otherwise it is keyed by pos->pawn_key. */
+void pawn_evaluate(const Position *pos, PawnTable *pt, int *mg, int *eg);
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef PERFT_H
+#define PERFT_H
+
+#include "position.h"
+#include <stdint.h>
+
+#include <stddef.h>
+
+typedef struct PerftTable PerftTable;
+
+typedef struct {
+    uint64_t nodes;
+    uint64_t captures;
+    uint64_t en_passant;
+    uint64_t castles;
+    uint64_t promotions;
+    uint64_t checks;
+    uint64_t checkmates;
+} PerftStats;
+
+int perft_default_threads(void);
+
+uint64_t perft_parallel(const Position *pos, int depth, int threads);
+
+PerftTable *perft_table_create(size_t megabytes);
+void perft_table_destroy(PerftTable *table);
+void perft_table_clear(PerftTable *table);
+uint64_t perft_hashed(const Position *pos, int depth, int threads, PerftTable *table);
+
+void perft_detailed(const Position *pos, int depth, PerftStats *stats_by_ply);
+
+#endif
@@ -0,0 +1,68 @@
+#ifndef PGN_H
+#define PGN_H
+
+#include "position.h"
+#include "movegen.h"
+#include <stddef.h>
+
+/* Streaming PGN reader. The input is memory-mapped (or a caller buffer) and
+ * parsed in place without allocating, so memory use does not grow with the
+ * file. Comments, ';' and '%' lines, variations and NAGs are skipped; only
+ * the main line is replayed. */
+#define PGN_MAX_TAGS 32
+
+typedef struct {
+    const char *name;
+    size_t name_len;
+    const char *value;          /* raw, backslash escapes left in place */
+    size_t value_len;
+} PgnTag;
+
+typedef struct {
+    PgnTag tags[PGN_MAX_TAGS];  /* the first PGN_MAX_TAGS tag pairs */
+    int tag_count;
+    Position pos;               /* the start position, then the position after each move */
+    int plies;                  /* moves replayed so far */
+    const char *result;         /* "1-0", "0-1", "1/2-1/2", "*", or NULL if the game just stopped */
+    size_t result_len;
+    size_t line;                /* 1-based line where the game starts */
+    size_t offset;              /* byte offset of the game in the reader's input */
+    pos_error_t status;         /* POS_OK, or why the game could not be replayed */
+    char error[160];            /* "line N: reason" when status != POS_OK */
+} PgnGame;
+
+typedef struct {
+    const char *data;
+    size_t size;
+    size_t offset;
+    size_t line;
+    unsigned flags;             /* FEN_* flags for FEN tags */
+    int in_game;                /* inside a game's movetext */
+    int mapped;
+} PgnReader;
+
+pos_error_t pgn_open(PgnReader *r, const char *path, unsigned flags, char *errbuf, size_t errbuf_size);
+void pgn_open_buffer(PgnReader *r, const char *data, size_t size, unsigned flags);
+void pgn_close(PgnReader *r);
+
+/* Read the tag section of the next game and set g->pos to its start position
+ * (the FEN tag, else the standard position). Moves the previous game did not
+ * consume are skipped. Returns 0 at end of input. A game with a bad FEN tag is
+ * still returned, with g->status set, so the caller can report it and go on. */
+int pgn_next_game(PgnReader *r, PgnGame *g);
+
+/* Resolve the next main-line SAN move, play it on g->pos and store it in
+ * *move. Returns 0 at the end of the game, or on an unresolvable move, in
+ * which case g->status and g->error say where. */
+int pgn_next_move(PgnReader *r, PgnGame *g, Move *move);
+
+/* Value of the tag called name, or NULL. */
+const char *pgn_tag(const PgnGame *g, const char *name, size_t *len);
+
+/* Split data into at most parts chunks that each start at a game's tag
+ * section, for reading in parallel with one pgn_open_buffer reader per chunk.
+ * starts[0] is 0; chunk i runs to starts[i + 1] (or size). Returns the number
+ * of chunks. Line numbers reported by a chunk reader count from its start. */
+size_t pgn_split(const char *data, size_t size, size_t *starts, size_t parts);
+
+#endif
@@ -38,13 +38,29 @@ typedef enum {
     POS_ERR_OTHER
 } pos_error_t;
 
+#define NNUE_HIDDEN 128
+
+/* First-layer NNUE sums, one row per perspective (see nnue.h). Searches keep
+ * a stack of them, one per ply, and attach it with nnue_attach. */
+typedef struct {
+    _Alignas(32) int16_t values[2][NNUE_HIDDEN];
+} NNUEAccumulator;
+
 typedef struct {
     int8_t board[64];
+    uint64_t type_bb[7];
+    uint64_t color_bb[2];
+    uint64_t hash;
+    uint64_t pawn_key;          /* Zobrist keys of the pawns alone, for the pawn hash table */
+    int16_t psq_mg;             /* white-relative material + piece-square, see eval.h */
+    int16_t psq_eg;
+    uint8_t phase;
     uint8_t side_to_move;
     uint8_t castling;
     int8_t en_passant;
     uint16_t halfmove_clock;
     uint32_t fullmove_number;
+    NNUEAccumulator *nnue;      /* top of an attached accumulator stack, NULL = none */
 } Position;
 
 #define SQ_INDEX(file, rank)  ((rank) * 8 + (file))
@@ -54,13 +70,37 @@ typedef struct {
 static inline int piece_abs(int8_t v) { return v == 0 ? 0 : (v > 0 ? v : -v); }
 static inline int piece_color(int8_t v) { return v > 0 ? COLOR_WHITE : (v < 0 ? COLOR_BLACK : -1); }
 
+static inline uint64_t position_occupied(const Position *pos) { return pos->color_bb[COLOR_WHITE] | pos->color_bb[COLOR_BLACK]; }
+static inline uint64_t position_pieces(const Position *pos, int color, int type) { return pos->color_bb[color] & pos->type_bb[type]; }
+
 void position_init(Position *pos);
+void position_sync_bitboards(Position *pos);
 
 pos_error_t position_from_fen(Position *pos, const char *fen,
                               char *errbuf, size_t errbuf_size);
 
+/* Flags for position_from_fen_n. */
+#define FEN_NO_VALIDATE (1u << 0)   /* skip position_validate (king counts, key and accumulator checks) */
+#define FEN_EPD         (1u << 1)   /* halfmove/fullmove may be absent, as in EPD; they default to 0 and 1 */
+
+/* Parse the FEN in fen[0..len), which need not be NUL-terminated. *stop (if not
+ * NULL) receives the offset just past the last field parsed, or where parsing
+ * failed; anything after the fields, such as EPD operations, is left alone. */
+pos_error_t position_from_fen_n(Position *pos, const char *fen, size_t len, unsigned flags,
+                                size_t *stop, char *errbuf, size_t errbuf_size);
+
+/* Longest FEN position_to_fen can write, including the NUL. */
+#define POS_FEN_MAX 128
+
 pos_error_t position_to_fen(const Position *pos, char *buf, size_t buf_size);
 
+/* Serialize positions[0..count) into buf as newline-terminated FENs, back to
+ * back and without a NUL. Stops with POS_ERR_BUF_SMALL at the first FEN that
+ * does not fit; *done and *written (if not NULL) receive the number of
+ * positions and bytes written, so the caller can flush and resume. */
+pos_error_t position_to_fen_batch(const Position *positions, size_t count, char *buf, size_t buf_size,
+                                  size_t *done, size_t *written);
+
 void position_print_ascii(const Position *pos, FILE *out);
 
 pos_error_t position_validate(const Position *pos, char *errbuf, size_t errbuf_size);
@@ -0,0 +1,64 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include "position.h"
+#include "movegen.h"
+#include "tt.h"
+#include <stdatomic.h>
+#include <stdint.h>
+
+#define SEARCH_MAX_PLY 128
+
+#define SCORE_INFINITE   32001
+#define SCORE_MATE       32000
+#define SCORE_MATE_BOUND (SCORE_MATE - SEARCH_MAX_PLY)
+
+typedef struct {
+    Move best_move;
+    int score;
+    int depth;
+    int seldepth;
+    uint64_t nodes;
+    uint64_t tt_probes;
+    uint64_t tt_hits;
+    uint64_t tt_cutoffs;
+    uint64_t pawn_probes;       /* main thread's pawn hash table */
+    uint64_t pawn_hits;
+    double seconds;
+    int pv_length;
+    Move pv[SEARCH_MAX_PLY];
+} SearchResult;
+
+typedef struct {
+    int depth;                  /* deepest iteration; 0 = SEARCH_MAX_PLY - 1 */
+    uint64_t nodes;             /* node budget; 0 = unlimited */
+    int64_t movetime_ms;        /* hard wall-clock budget, polled during the search; 0 = unlimited */
+    int64_t soft_ms;            /* no new iteration past this, stretched or cut by best-move stability (timeman.h); 0 = none */
+    atomic_bool *stop;          /* optional flag another thread sets to abort */
+    atomic_bool *ponder;        /* optional; while set, movetime_ms and soft_ms wait and then count from its clearing */
+    TTable *tt;                 /* optional transposition table, kept across searches */
+    int threads;                /* Lazy SMP threads sharing tt; <= 1 or no tt = single-threaded */
+    const uint64_t *history;    /* keys of the positions before pos, oldest first */
+    int history_count;
+    void (*on_iteration)(const SearchResult *result, void *ctx);
+    void *ctx;
+} SearchLimits;
+
+void search_limits_init(SearchLimits *limits);
+
+/* Iterative-deepening alpha-beta from pos. pos is restored before returning.
+ * Returns the best move of the last completed iteration (MOVE_NONE when pos has no legal moves). */
+Move search(Position *pos, const SearchLimits *limits, SearchResult *result);
+
+/* Tactical resolution of pos alone: captures and promotions until the position is quiet. */
+int search_quiescence(Position *pos, int alpha, int beta, uint64_t *nodes);
+
+static inline int score_is_mate(int score) { return score > SCORE_MATE_BOUND || score < -SCORE_MATE_BOUND; }
+
+/* Full moves to mate, negative when the side to move is being mated. */
+static inline int score_mate_in(int score)
+{
+    return score > 0 ? (SCORE_MATE - score + 1) / 2 : -(SCORE_MATE + score) / 2;
+}
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef TIMEMAN_H
+#define TIMEMAN_H
+
+#include <stdint.h>
+
+#define TIME_DEFAULT_OVERHEAD_MS 30
+
+/* soft: do not start another iteration once this much has elapsed.
+ * hard: abort the search in progress (SearchLimits.movetime_ms). */
+typedef struct {
+    int64_t soft_ms;
+    int64_t hard_ms;
+} TimeBudget;
+
+/* Budget for one move with time_left_ms on our clock, inc_ms added per move
+ * and moves_to_go moves until the next time control (0 = sudden death).
+ * overhead_ms is kept in reserve for communication lag; hard_ms always stays
+ * below time_left_ms - overhead_ms. */
+TimeBudget time_budget(int64_t time_left_ms, int64_t inc_ms, int moves_to_go, int64_t overhead_ms);
+
+/* Soft limit after the best move has survived stable_iterations completed
+ * iterations unchanged: a move that keeps changing gets more time, a settled one less. */
+int64_t time_soft_limit(int64_t soft_ms, int stable_iterations);
+
+#endif
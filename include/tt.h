@@ -0,0 +1,63 @@
+#ifndef TT_H
+#define TT_H
+
+#include "movegen.h"
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define TT_BOUND_NONE  0
+#define TT_BOUND_UPPER 1
+#define TT_BOUND_LOWER 2
+#define TT_BOUND_EXACT 3
+
+#define TT_BUCKET_ENTRIES 4
+
+/* Lockless entry, as in the perft table: check holds key ^ data so a torn write
+ * from another thread fails verification.
+ * data: bits 0-15 move, 16-31 score + 32768, 32-39 depth, 40-41 bound, 42-47 generation. */
+typedef struct {
+    _Atomic uint64_t check;
+    _Atomic uint64_t data;
+} TTEntry;
+
+/* One 64-byte cache line per bucket, so a probe touches a single line. */
+typedef struct {
+    _Alignas(64) TTEntry entries[TT_BUCKET_ENTRIES];
+} TTBucket;
+
+typedef struct {
+    TTBucket *buckets;
+    size_t mask;
+    uint8_t generation;
+} TTable;
+
+typedef struct {
+    Move move;
+    int score;
+    int depth;
+    int bound;
+} TTHit;
+
+TTable *tt_create(size_t megabytes);
+void tt_destroy(TTable *tt);
+void tt_clear(TTable *tt);
+void tt_new_search(TTable *tt);
+
+int tt_probe(const TTable *tt, uint64_t key, TTHit *hit);
+void tt_store(TTable *tt, uint64_t key, int depth, int bound, int score, Move move);
+
+/* Permille of sampled entries written during the current search. */
+int tt_hashfull(const TTable *tt);
+
+static inline TTBucket *tt_bucket(const TTable *tt, uint64_t key)
+{
+    return &tt->buckets[key & tt->mask];
+}
+
+static inline void tt_prefetch(const TTable *tt, uint64_t key)
+{
+    __builtin_prefetch(tt_bucket(tt, key));
+}
+
+#endif
@@ -0,0 +1,14 @@
+#ifndef UCI_H
+#define UCI_H
+
+#include <stdio.h>
+
+#define UCI_ENGINE_NAME "c-chess-engine"
+#define UCI_DEFAULT_HASH_MB 16
+
+/* Run the UCI protocol until "quit" or end of input. Commands are read on the
+ * calling thread while "go" searches on a thread of its own, so "stop" and
+ * "isready" are answered while a search is running. Returns 0 on "quit" or EOF. */
+int uci_loop(FILE *in, FILE *out);
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include "position.h"
+#include <stdint.h>
+
+extern uint64_t zobrist_piece[2][7][64];
+extern uint64_t zobrist_castling[16];
+extern uint64_t zobrist_ep_file[8];
+extern uint64_t zobrist_side;
+
+void zobrist_init(void);
+
+uint64_t zobrist_compute(const Position *pos);
+uint64_t zobrist_compute_pawns(const Position *pos);
+
+static inline uint64_t zobrist_piece_key(int8_t v, int sq)
+{
+    return zobrist_piece[v < 0][piece_abs(v)][sq];
+}
+
+#endif
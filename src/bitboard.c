@@ -0,0 +1,187 @@
+#include "bitboard.h"
+#include "position.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+Bitboard bb_knight_attacks[64];
+Bitboard bb_king_attacks[64];
+Bitboard bb_pawn_attacks[2][64];
+Bitboard bb_rays[DIR_COUNT][64];
+Bitboard bb_between[64][64];
+Bitboard bb_line[64][64];
+
+Magic bb_rook_magics[64];
+Magic bb_bishop_magics[64];
+
+static Bitboard rook_table[0x19000];
+static Bitboard bishop_table[0x1480];
+
+static const Bitboard rook_magic_numbers[64] = {
+    0x1080004008801020ULL, 0x0840092002c03000ULL, 0x1900200010400900ULL, 0x0880100008000480ULL,
+    0x4200100420080200ULL, 0x8100020100080400ULL, 0x0200040110886200ULL, 0x0200008040220411ULL,
+    0x0404800084400220ULL, 0x0000401000402000ULL, 0x0086001081220440ULL, 0x0408800800100280ULL,
+    0x000a001201040820ULL, 0x8848800200840080ULL, 0x4001000100040200ULL, 0x0442000102105084ULL,
+    0x9080010020804100ULL, 0x0040404000201009ULL, 0x0000808010002009ULL, 0x2200090021d00100ULL,
+    0x0008008008040080ULL, 0x0004004002010040ULL, 0x0011040008015042ULL, 0x00000a0001768104ULL,
+    0x0000800080204009ULL, 0x2010004140002001ULL, 0x9800200280100080ULL, 0x1000100080080080ULL,
+    0x0442000a00049020ULL, 0x2100040080020080ULL, 0x0800120400900148ULL, 0x0010040a00128541ULL,
+    0x2800804000800030ULL, 0x1010002000400041ULL, 0x4000200011004100ULL, 0x0610008410800800ULL,
+    0x0400802402800800ULL, 0xc100020080800400ULL, 0x0002000802000401ULL, 0x0182085882000401ULL,
+    0x0220204000808000ULL, 0x2860100040024022ULL, 0x0001002004110040ULL, 0x99101042000a0020ULL,
+    0x0004080004008080ULL, 0x0010040002008080ULL, 0x2012004881020004ULL, 0x8300842444820011ULL,
+    0x0088403882010200ULL, 0x0820400080210100ULL, 0x0110910040a00300ULL, 0x0801100280080480ULL,
+    0x0242009008200600ULL, 0x1002000489500200ULL, 0x0040800200010080ULL, 0x0091800041000080ULL,
+    0x0000209300488001ULL, 0x04c1002414824001ULL, 0x020020000b001041ULL, 0x7000100004200901ULL,
+    0x8002002004100802ULL, 0x30010002084c0007ULL, 0x0888221800813004ULL, 0x4000002840840112ULL
+};
+
+static const Bitboard bishop_magic_numbers[64] = {
+    0xa010041108003100ULL, 0x006082020a002900ULL, 0x6810010619200000ULL, 0x08281a0520000408ULL,
+    0x0001104001000400ULL, 0x0018901008048400ULL, 0x00040a0210245280ULL, 0x000200210808a402ULL,
+    0x9140048410821200ULL, 0x0800091010820041ULL, 0x20504804832202c0ULL, 0x0100091401081000ULL,
+    0x8021011140000012ULL, 0x0810020804450400ULL, 0x208b0542109008a2ULL, 0x0080084a08040204ULL,
+    0x0040e2a80811244cULL, 0x2505022008008108ULL, 0x0430220100420040ULL, 0x010a040420220040ULL,
+    0x1105000290400000ULL, 0x0093001200822120ULL, 0x4000a62048043004ULL, 0x280120048a015004ULL,
+    0x006090002a020814ULL, 0x44042000240800d0ULL, 0x01102800040a4400ULL, 0x1004080080220040ULL,
+    0x0001001011004024ULL, 0x0010044000805040ULL, 0x0914041200820100ULL, 0x0004821012821480ULL,
+    0x0024040500c05021ULL, 0x0088611002080200ULL, 0x0116080a00040020ULL, 0x4000020080080080ULL,
+    0x2450450140840040ULL, 0x0000880201484100ULL, 0x0222020404020092ULL, 0x8081110600002e00ULL,
+    0x2842101105000801ULL, 0x1100809008001025ULL, 0x00020202221c0400ULL, 0x0422014022009020ULL,
+    0x0210046102100c00ULL, 0xc004008082029102ULL, 0x00aa461801101200ULL, 0x0404080080201108ULL,
+    0x020542108c205002ULL, 0x0410544804100100ULL, 0x0040910841100000ULL, 0x0400200042021100ULL,
+    0x00004204850400c0ULL, 0x0200100410a42102ULL, 0x1040020801210102ULL, 0x0805040410420000ULL,
+    0x2884804130100200ULL, 0x800c262201242000ULL, 0x1058000194108800ULL, 0x0014221054420204ULL,
+    0x0104000012a02200ULL, 0x0200881003300100ULL, 0x0140400202840100ULL, 0x0402020801010201ULL
+};
+
+static const int dir_deltas[DIR_COUNT][2] = {
+    { 0, 1}, { 1, 0}, { 1, 1}, {-1, 1},
+    { 0,-1}, {-1, 0}, {-1,-1}, { 1,-1}
+};
+
+static Bitboard leaper_mask(int sq, const int (*deltas)[2], int count)
+{
+    Bitboard b = BB_EMPTY;
+    int f = SQ_FILE(sq), r = SQ_RANK(sq);
+    for (int i = 0; i < count; ++i) {
+        int ff = f + deltas[i][0], rr = r + deltas[i][1];
+        if (ff < 0 || ff > 7 || rr < 0 || rr > 7) continue;
+        b |= BB_SQUARE(SQ_INDEX(ff, rr));
+    }
+    return b;
+}
+
+static inline Bitboard ray_attacks(int dir, int sq, Bitboard occ)
+{
+    Bitboard attacks = bb_rays[dir][sq];
+    Bitboard blockers = attacks & occ;
+    if (blockers) {
+        int b = dir < DIR_SOUTH ? bb_lsb(blockers) : bb_msb(blockers);
+        attacks ^= bb_rays[dir][b];
+    }
+    return attacks;
+}
+
+Bitboard bb_rook_attacks_slow(int sq, Bitboard occ)
+{
+    return ray_attacks(DIR_NORTH, sq, occ) | ray_attacks(DIR_EAST, sq, occ) |
+           ray_attacks(DIR_SOUTH, sq, occ) | ray_attacks(DIR_WEST, sq, occ);
+}
+
+Bitboard bb_bishop_attacks_slow(int sq, Bitboard occ)
+{
+    return ray_attacks(DIR_NORTH_EAST, sq, occ) | ray_attacks(DIR_NORTH_WEST, sq, occ) |
+           ray_attacks(DIR_SOUTH_WEST, sq, occ) | ray_attacks(DIR_SOUTH_EAST, sq, occ);
+}
+
+static Bitboard slider_mask(int sq, const int *dirs)
+{
+    Bitboard mask = BB_EMPTY;
+    for (int i = 0; i < 4; ++i) {
+        Bitboard ray = bb_rays[dirs[i]][sq];
+        if (ray == BB_EMPTY) continue;
+        int edge = dirs[i] < DIR_SOUTH ? bb_msb(ray) : bb_lsb(ray);
+        mask |= ray & ~BB_SQUARE(edge);
+    }
+    return mask;
+}
+
+static void init_magics(Magic *magics, const Bitboard *numbers, const int *dirs,
+                             Bitboard (*slow)(int, Bitboard), Bitboard *table)
+{
+    for (int sq = 0; sq < 64; ++sq) {
+        Magic *m = &magics[sq];
+        m->mask = slider_mask(sq, dirs);
+        m->magic = numbers[sq];
+        m->shift = 64u - (unsigned)bb_popcount(m->mask);
+        m->attacks = table;
+        Bitboard occ = BB_EMPTY;
+        do {
+            m->attacks[magic_index(m, occ)] = slow(sq, occ);
+            occ = (occ - m->mask) & m->mask;
+        } while (occ);
+        table += 1ULL << bb_popcount(m->mask);
+    }
+}
+
+void bitboard_init(void)
+{
+    const int knight_deltas[8][2] = { {2,1},{1,2},{-1,2},{-2,1},{-2,-1},{-1,-2},{1,-2},{2,-1} };
+    const int king_deltas[8][2] = { {1,0},{-1,0},{0,1},{0,-1},{1,1},{1,-1},{-1,1},{-1,-1} };
+    const int white_pawn_deltas[2][2] = { {-1,1},{1,1} };
+    const int black_pawn_deltas[2][2] = { {-1,-1},{1,-1} };
+
+    for (int sq = 0; sq < 64; ++sq) {
+        bb_knight_attacks[sq] = leaper_mask(sq, knight_deltas, 8);
+        bb_king_attacks[sq] = leaper_mask(sq, king_deltas, 8);
+        bb_pawn_attacks[COLOR_WHITE][sq] = leaper_mask(sq, white_pawn_deltas, 2);
+        bb_pawn_attacks[COLOR_BLACK][sq] = leaper_mask(sq, black_pawn_deltas, 2);
+        for (int d = 0; d < DIR_COUNT; ++d) {
+            Bitboard ray = BB_EMPTY;
+            int ff = SQ_FILE(sq) + dir_deltas[d][0];
+            int rr = SQ_RANK(sq) + dir_deltas[d][1];
+            for (; ff >= 0 && ff < 8 && rr >= 0 && rr < 8; ff += dir_deltas[d][0], rr += dir_deltas[d][1])
+                ray |= BB_SQUARE(SQ_INDEX(ff, rr));
+            bb_rays[d][sq] = ray;
+        }
+    }
+
+    for (int a = 0; a < 64; ++a) {
+        for (int d = 0; d < DIR_COUNT; ++d) {
+            Bitboard ray = bb_rays[d][a];
+            while (ray) {
+                int b = bb_pop_lsb(&ray);
+                bb_between[a][b] = bb_rays[d][a] & bb_rays[d ^ 4][b];
+                bb_line[a][b] = bb_rays[d][a] | bb_rays[d ^ 4][a] | BB_SQUARE(a);
+            }
+        }
+    }
+
+    static const int rook_dirs[4] = { DIR_NORTH, DIR_EAST, DIR_SOUTH, DIR_WEST };
+    static const int bishop_dirs[4] = { DIR_NORTH_EAST, DIR_NORTH_WEST, DIR_SOUTH_WEST, DIR_SOUTH_EAST };
+    init_magics(bb_rook_magics, rook_magic_numbers, rook_dirs, bb_rook_attacks_slow, rook_table);
+    init_magics(bb_bishop_magics, bishop_magic_numbers, bishop_dirs, bb_bishop_attacks_slow, bishop_table);
+}
+
+const char *bitboard_slider_backend(void)
+{
+#if defined(USE_PEXT)
+    return "pext";
+#else
+    return "magic";
+#endif
+}
+
+__attribute__((constructor))
+static void bitboard_init_at_startup(void)
+{
+#if defined(USE_PEXT) && (defined(__x86_64__) || defined(__i386__))
+    __builtin_cpu_init();
+    if (!__builtin_cpu_supports("bmi2")) {
+        fprintf(stderr, "bitboard: built with USE_PEXT but this CPU lacks BMI2; rebuild without PEXT=1\n");
+        abort();
+    }
+#endif
+    bitboard_init();
+}
+
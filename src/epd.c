@@ -0,0 +1,111 @@
+#define _POSIX_C_SOURCE 200809L
+#include "epd.h"
+#include "mapfile.h"
+#include <stdio.h>
+#include <string.h>
+
+static inline int epd_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+pos_error_t epd_open(EpdReader *r, const char *path, unsigned flags, char *errbuf, size_t errbuf_size)
+{
+    if (r == NULL || path == NULL) {
+        if (errbuf && errbuf_size) snprintf(errbuf, errbuf_size, "null argument");
+        return POS_ERR_INVALID_ARG;
+    }
+    epd_open_buffer(r, NULL, 0, flags);
+
+    const void *data;
+    size_t size;
+    pos_error_t err = map_file(path, &data, &size, errbuf, errbuf_size);
+    if (err != POS_OK) return err;
+    r->data = data;
+    r->size = size;
+    r->mapped = data != NULL;
+    return POS_OK;
+}
+
+void epd_open_buffer(EpdReader *r, const char *data, size_t size, unsigned flags)
+{
+    if (r == NULL) return;
+    r->data = data;
+    r->size = data ? size : 0;
+    r->offset = 0;
+    r->line = 0;
+    r->flags = flags;
+    r->mapped = 0;
+}
+
+void epd_close(EpdReader *r)
+{
+    if (r == NULL) return;
+    if (r->mapped) unmap_file(r->data, r->size);
+    epd_open_buffer(r, NULL, 0, r->flags);
+}
+
+int epd_next(EpdReader *r, Position *pos, EpdRecord *rec, char *errbuf, size_t errbuf_size)
+{
+    while (r->offset < r->size) {
+        const char *line = r->data + r->offset;
+        size_t len = r->size - r->offset;
+        const char *nl = memchr(line, '\n', len);
+        if (nl) len = (size_t)(nl - line);
+        size_t line_offset = r->offset;
+        r->offset += nl ? len + 1 : len;
+        r->line++;
+
+        size_t start = 0;
+        while (start < len && epd_space(line[start])) start++;
+        while (len > start && epd_space(line[len - 1])) len--;
+        if (start == len || line[start] == '#') continue;
+
+        const char *text = line + start;
+        size_t text_len = len - start;
+        size_t stop = 0;
+        char reason[128];
+        rec->line = r->line;
+        rec->offset = line_offset;
+        rec->fen = text;
+        rec->status = position_from_fen_n(pos, text, text_len, r->flags | FEN_EPD, &stop, reason, sizeof reason);
+        rec->fen_len = stop;
+        rec->error_column = 0;
+        if (rec->status != POS_OK) {
+            rec->error_column = start + stop + 1;
+            if (errbuf && errbuf_size)
+                snprintf(errbuf, errbuf_size, "line %zu, column %zu: %s", rec->line, rec->error_column, reason);
+        }
+        while (stop < text_len && epd_space(text[stop])) stop++;
+        rec->ops = text + stop;
+        rec->ops_len = text_len - stop;
+        return 1;
+    }
+    return 0;
+}
+
+const char *epd_operand(const EpdRecord *rec, const char *opcode, size_t *len)
+{
+    size_t opcode_len = strlen(opcode);
+    const char *p = rec->ops, *end = rec->ops + rec->ops_len;
+    while (p < end) {
+        while (p < end && (epd_space(*p) || *p == ';')) p++;
+        const char *name = p;
+        while (p < end && !epd_space(*p) && *p != ';') p++;
+        const char *name_end = p;
+        while (p < end && epd_space(*p)) p++;
+        const char *operand = p;
+        int quoted = 0;
+        while (p < end && (quoted || *p != ';')) {
+            if (*p == '"') quoted = !quoted;
+            p++;
+        }
+        const char *operand_end = p;
+        while (operand_end > operand && epd_space(operand_end[-1])) operand_end--;
+        if ((size_t)(name_end - name) == opcode_len && memcmp(name, opcode, opcode_len) == 0) {
+            if (len) *len = (size_t)(operand_end - operand);
+            return operand;
+        }
+    }
+    return NULL;
+}
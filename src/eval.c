@@ -0,0 +1,147 @@
+#include "eval.h"
+#include "nnue.h"
+#include "pawns.h"
+
+const int eval_piece_value[7] = { 0, 100, 320, 330, 500, 900, 0 };
+
+static const int eval_value_eg[7] = { 0, 120, 290, 320, 540, 930, 0 };
+
+const uint8_t eval_phase_weight[7] = { 0, 0, 1, 1, 2, 4, 0 };
+
+int16_t eval_psq_mg[13][64];
+int16_t eval_psq_eg[13][64];
+
+/* Piece-square bonuses for white, rank 8 first so the tables read like a board diagram. */
+static const int8_t pst_pawn_mg[64] = {
+     0,  0,  0,  0,  0,  0,  0,  0,
+    50, 50, 50, 50, 50, 50, 50, 50,
+    10, 10, 20, 30, 30, 20, 10, 10,
+     5,  5, 10, 25, 25, 10,  5,  5,
+     0,  0,  0, 20, 20,  0,  0,  0,
+     5, -5,-10,  0,  0,-10, -5,  5,
+     5, 10, 10,-20,-20, 10, 10,  5,
+     0,  0,  0,  0,  0,  0,  0,  0,
+};
+
+static const int8_t pst_pawn_eg[64] = {
+     0,  0,  0,  0,  0,  0,  0,  0,
+    90, 90, 90, 90, 90, 90, 90, 90,
+    60, 60, 60, 60, 60, 60, 60, 60,
+    35, 35, 35, 35, 35, 35, 35, 35,
+    20, 20, 20, 20, 20, 20, 20, 20,
+    10, 10, 10, 10, 10, 10, 10, 10,
+     0,  0,  0,  0,  0,  0,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,
+};
+
+static const int8_t pst_knight[64] = {
+   -50,-40,-30,-30,-30,-30,-40,-50,
+   -40,-20,  0,  0,  0,  0,-20,-40,
+   -30,  0, 10, 15, 15, 10,  0,-30,
+   -30,  5, 15, 20, 20, 15,  5,-30,
+   -30,  0, 15, 20, 20, 15,  0,-30,
+   -30,  5, 10, 15, 15, 10,  5,-30,
+   -40,-20,  0,  5,  5,  0,-20,-40,
+   -50,-40,-30,-30,-30,-30,-40,-50,
+};
+
+static const int8_t pst_bishop[64] = {
+   -20,-10,-10,-10,-10,-10,-10,-20,
+   -10,  0,  0,  0,  0,  0,  0,-10,
+   -10,  0,  5, 10, 10,  5,  0,-10,
+   -10,  5,  5, 10, 10,  5,  5,-10,
+   -10,  0, 10, 10, 10, 10,  0,-10,
+   -10, 10, 10, 10, 10, 10, 10,-10,
+   -10,  5,  0,  0,  0,  0,  5,-10,
+   -20,-10,-10,-10,-10,-10,-10,-20,
+};
+
+static const int8_t pst_rook[64] = {
+     0,  0,  0,  0,  0,  0,  0,  0,
+     5, 10, 10, 10, 10, 10, 10,  5,
+    -5,  0,  0,  0,  0,  0,  0, -5,
+    -5,  0,  0,  0,  0,  0,  0, -5,
+    -5,  0,  0,  0,  0,  0,  0, -5,
+    -5,  0,  0,  0,  0,  0,  0, -5,
+    -5,  0,  0,  0,  0,  0,  0, -5,
+     0,  0,  0,  5,  5,  0,  0,  0,
+};
+
+static const int8_t pst_queen[64] = {
+   -20,-10,-10, -5, -5,-10,-10,-20,
+   -10,  0,  0,  0,  0,  0,  0,-10,
+   -10,  0,  5,  5,  5,  5,  0,-10,
+    -5,  0,  5,  5,  5,  5,  0, -5,
+     0,  0,  5,  5,  5,  5,  0, -5,
+   -10,  5,  5,  5,  5,  5,  0,-10,
+   -10,  0,  5,  0,  0,  0,  0,-10,
+   -20,-10,-10, -5, -5,-10,-10,-20,
+};
+
+static const int8_t pst_king_mg[64] = {
+   -30,-40,-40,-50,-50,-40,-40,-30,
+   -30,-40,-40,-50,-50,-40,-40,-30,
+   -30,-40,-40,-50,-50,-40,-40,-30,
+   -30,-40,-40,-50,-50,-40,-40,-30,
+   -20,-30,-30,-40,-40,-30,-30,-20,
+   -10,-20,-20,-20,-20,-20,-20,-10,
+    20, 20,  0,  0,  0,  0, 20, 20,
+    20, 30, 10,  0,  0, 10, 30, 20,
+};
+
+static const int8_t pst_king_eg[64] = {
+   -50,-40,-30,-20,-20,-30,-40,-50,
+   -30,-20,-10,  0,  0,-10,-20,-30,
+   -30,-10, 20, 30, 30, 20,-10,-30,
+   -30,-10, 30, 40, 40, 30,-10,-30,
+   -30,-10, 30, 40, 40, 30,-10,-30,
+   -30,-10, 20, 30, 30, 20,-10,-30,
+   -30,-30,  0,  0,  0,  0,-30,-30,
+   -50,-30,-30,-30,-30,-30,-30,-50,
+};
+
+static const int8_t *const pst_mg[7] = { NULL, pst_pawn_mg, pst_knight, pst_bishop, pst_rook, pst_queen, pst_king_mg };
+static const int8_t *const pst_eg[7] = { NULL, pst_pawn_eg, pst_knight, pst_bishop, pst_rook, pst_queen, pst_king_eg };
+
+/* White reads its table through sq ^ 56 (a1 is the table's bottom-left);
+ * black reads it unflipped and contributes with the opposite sign. */
+__attribute__((constructor))
+static void eval_init(void)
+{
+    for (int pt = PIECE_PAWN; pt <= PIECE_KING; ++pt) {
+        for (int sq = 0; sq < 64; ++sq) {
+            int mg = eval_piece_value[pt] + pst_mg[pt][sq ^ 56];
+            int eg = eval_value_eg[pt] + pst_eg[pt][sq ^ 56];
+            eval_psq_mg[6 + pt][sq] = (int16_t)mg;
+            eval_psq_eg[6 + pt][sq] = (int16_t)eg;
+            eval_psq_mg[6 - pt][sq ^ 56] = (int16_t)-mg;
+            eval_psq_eg[6 - pt][sq ^ 56] = (int16_t)-eg;
+        }
+    }
+}
+
+void eval_refresh(Position *pos)
+{
+    pos->psq_mg = 0;
+    pos->psq_eg = 0;
+    pos->phase = 0;
+    for (int sq = 0; sq < 64; ++sq) {
+        int8_t v = pos->board[sq];
+        if (v != PIECE_EMPTY && piece_abs(v) <= PIECE_KING) eval_add_piece(pos, sq, v);
+    }
+}
+
+int evaluate_cached(const Position *pos, PawnTable *pawns)
+{
+    if (nnue_net) return nnue_evaluate(pos);
+    int mg = pos->psq_mg, eg = pos->psq_eg;
+    pawn_evaluate(pos, pawns, &mg, &eg);
+    int phase = pos->phase < EVAL_PHASE_MAX ? pos->phase : EVAL_PHASE_MAX;
+    int score = (mg * phase + eg * (EVAL_PHASE_MAX - phase)) / EVAL_PHASE_MAX;
+    return pos->side_to_move == COLOR_WHITE ? score : -score;
+}
+
+int evaluate(const Position *pos)
+{
+    return evaluate_cached(pos, NULL);
+}
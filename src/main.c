@@ -1,6 +1,65 @@
-#include "mylib.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include "position.h"
+#include "movegen.h"
+#include "search.h"
+#include "nnue.h"
 
-int main() {
-    hello();
+#define START_FEN "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"
+
+static void print_iteration(const SearchResult *r, void *ctx)
+{
+    const TTable *tt = ctx;
+    char mv[MOVE_UCI_MAX];
+    if (score_is_mate(r->score)) printf("info depth %d seldepth %d score mate %d", r->depth, r->seldepth, score_mate_in(r->score));
+    else printf("info depth %d seldepth %d score cp %d", r->depth, r->seldepth, r->score);
+    printf(" nodes %llu nps %.0f time %.0f", (unsigned long long)r->nodes,
+           r->seconds > 0.0 ? (double)r->nodes / r->seconds : 0.0, r->seconds * 1000.0);
+    if (tt) printf(" hashfull %d tthit %.1f%%", tt_hashfull(tt), r->tt_probes ? 100.0 * (double)r->tt_hits / (double)r->tt_probes : 0.0);
+    if (r->pawn_probes) printf(" pawnhit %.1f%%", 100.0 * (double)r->pawn_hits / (double)r->pawn_probes);
+    printf(" pv");
+    for (int i = 0; i < r->pv_length; ++i) {
+        move_to_uci(r->pv[i], mv);
+        printf(" %s", mv);
+    }
+    printf("\n");
+    fflush(stdout);
+}
+
+int main(int argc, char **argv)
+{
+    const char *fen = argc > 1 ? argv[1] : START_FEN;
+    Position pos;
+    char err[256];
+    if (argc > 6 && nnue_load(argv[6], err, sizeof err) != POS_OK) {
+        fprintf(stderr, "nnue_load failed: %s\n", err);
+        return 2;
+    }
+    if (position_from_fen(&pos, fen, err, sizeof err) != POS_OK) {
+        fprintf(stderr, "position_from_fen failed: %s\n", err);
+        fprintf(stderr, "Usage: %s [FEN] [depth] [movetime_ms] [hash_mb] [threads] [nnue_file]\n", argv[0]);
+        return 2;
+    }
+
+    SearchLimits limits;
+    search_limits_init(&limits);
+    limits.depth = argc > 2 ? atoi(argv[2]) : 6;
+    limits.movetime_ms = argc > 3 ? atoll(argv[3]) : 0;
+    limits.on_iteration = print_iteration;
+    size_t hash_mb = argc > 4 ? (size_t)atoll(argv[4]) : 16;
+    if (hash_mb > 0 && !(limits.tt = tt_create(hash_mb))) {
+        fprintf(stderr, "failed to allocate %zu MB hash\n", hash_mb);
+        return 3;
+    }
+    limits.ctx = limits.tt;
+    limits.threads = argc > 5 ? atoi(argv[5]) : 1;
+
+    SearchResult result;
+    Move best = search(&pos, &limits, &result);
+    char mv[MOVE_UCI_MAX] = "0000";
+    if (best != MOVE_NONE) move_to_uci(best, mv);
+    printf("bestmove %s\n", mv);
+    tt_destroy(limits.tt);
+    nnue_unload();
     return 0;
 }
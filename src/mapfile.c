@@ -0,0 +1,42 @@
+#define _POSIX_C_SOURCE 200809L
+#include "mapfile.h"
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+pos_error_t map_file(const char *path, const void **data, size_t *size, char *errbuf, size_t errbuf_size)
+{
+    *data = NULL;
+    *size = 0;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        if (errbuf && errbuf_size) snprintf(errbuf, errbuf_size, "cannot open %s", path);
+        return POS_ERR_OTHER;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        if (errbuf && errbuf_size) snprintf(errbuf, errbuf_size, "cannot stat %s", path);
+        close(fd);
+        return POS_ERR_OTHER;
+    }
+    if (st.st_size > 0) {
+        void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED) {
+            if (errbuf && errbuf_size) snprintf(errbuf, errbuf_size, "cannot map %s", path);
+            close(fd);
+            return POS_ERR_OTHER;
+        }
+        posix_madvise(map, (size_t)st.st_size, POSIX_MADV_SEQUENTIAL);
+        *data = map;
+        *size = (size_t)st.st_size;
+    }
+    close(fd);
+    return POS_OK;
+}
+
+void unmap_file(const void *data, size_t size)
+{
+    if (data) munmap((void *)data, size);
+}
@@ -1,4 +1,8 @@
 #include "movegen.h"
+#include "bitboard.h"
+#include "zobrist.h"
+#include "eval.h"
+#include "nnue.h"
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
@@ -11,439 +15,595 @@ static inline int rank_of(int sq) { return SQ_RANK(sq); }
 int is_square_attacked(const Position *pos, int sq, int by)
 {
     if (sq < 0 || sq >= 64) return 0;
-    int f = file_of(sq);
-    int r = rank_of(sq);
-    if (by == COLOR_WHITE) {
-        if (r < 7) {
-            if (f > 0) {
-                int s = SQ_INDEX(f - 1, r + 1);
-                if (pos->board[s] == PIECE_PAWN) return 1;
-            }
-            if (f < 7) {
-                int s = SQ_INDEX(f + 1, r + 1);
-                if (pos->board[s] == PIECE_PAWN) return 1;
-            }
-        }
-    } else {
-        if (r > 0) {
-            if (f > 0) {
-                int s = SQ_INDEX(f - 1, r - 1);
-                if (pos->board[s] == -PIECE_PAWN) return 1;
-            }
-            if (f < 7) {
-                int s = SQ_INDEX(f + 1, r - 1);
-                if (pos->board[s] == -PIECE_PAWN) return 1;
-            }
-        }
-    }
-    const int knight_deltas[8][2] = { {2,1},{1,2},{-1,2},{-2,1},{-2,-1},{-1,-2},{1,-2},{2,-1} };
-    for (int i = 0; i < 8; ++i) {
-        int ff = f + knight_deltas[i][0];
-        int rr = r + knight_deltas[i][1];
-        if (ff < 0 || ff > 7 || rr < 0 || rr > 7) continue;
-        int s = SQ_INDEX(ff, rr);
-        int8_t v = pos->board[s];
-        if (v == PIECE_EMPTY) continue;
-        if (by == COLOR_WHITE && v == PIECE_KNIGHT) return 1;
-        if (by == COLOR_BLACK && v == -PIECE_KNIGHT) return 1;
-    }
-    for (int df = -1; df <= 1; ++df) {
-        for (int dr = -1; dr <= 1; ++dr) {
-            if (df == 0 && dr == 0) continue;
-            int ff = f + df, rr = r + dr;
-            if (ff < 0 || ff > 7 || rr < 0 || rr > 7) continue;
-            int s = SQ_INDEX(ff, rr);
-            int8_t v = pos->board[s];
-            if (v == PIECE_EMPTY) continue;
-            if (by == COLOR_WHITE && v == PIECE_KING) return 1;
-            if (by == COLOR_BLACK && v == -PIECE_KING) return 1;
-        }
-    }
-    const int dirs[8][2] = { {1,0},{-1,0},{0,1},{0,-1},{1,1},{1,-1},{-1,1},{-1,-1} };
-    for (int d = 0; d < 8; ++d) {
-        int df = dirs[d][0], dr = dirs[d][1];
-        int ff = f + df, rr = r + dr;
-        for (; ff >= 0 && ff < 8 && rr >= 0 && rr < 8; ff += df, rr += dr) {
-            int s = SQ_INDEX(ff, rr);
-            int8_t v = pos->board[s];
-            if (v == PIECE_EMPTY) continue;
-            int a = piece_abs(v);
-            if (by == COLOR_WHITE && v > 0) {
-                if (d < 4) {
-                    if (a == PIECE_ROOK || a == PIECE_QUEEN) return 1;
-                } else {
-                    if (a == PIECE_BISHOP || a == PIECE_QUEEN) return 1;
-                }
-            } else if (by == COLOR_BLACK && v < 0) {
-                if (d < 4) {
-                    if (a == PIECE_ROOK || a == PIECE_QUEEN) return 1;
-                } else {
-                    if (a == PIECE_BISHOP || a == PIECE_QUEEN) return 1;
-                }
-            }
-            break;
-        }
-    }
+    Bitboard them = pos->color_bb[by];
+    Bitboard occ = position_occupied(pos);
+    if (bb_pawn_attacks[by ^ 1][sq] & pos->type_bb[PIECE_PAWN] & them) return 1;
+    if (bb_knight_attacks[sq] & pos->type_bb[PIECE_KNIGHT] & them) return 1;
+    if (bb_king_attacks[sq] & pos->type_bb[PIECE_KING] & them) return 1;
+    Bitboard queens = pos->type_bb[PIECE_QUEEN];
+    if (bb_rook_attacks(sq, occ) & (pos->type_bb[PIECE_ROOK] | queens) & them) return 1;
+    if (bb_bishop_attacks(sq, occ) & (pos->type_bb[PIECE_BISHOP] | queens) & them) return 1;
     return 0;
 }
 
 static int find_king_sq(const Position *pos, int color)
 {
-    for (int i = 0; i < 64; ++i) {
-        int8_t v = pos->board[i];
-        if (color == COLOR_WHITE && v == PIECE_KING) return i;
-        if (color == COLOR_BLACK && v == -PIECE_KING) return i;
-    }
-    return POS_NO_SQUARE;
+    Bitboard king = position_pieces(pos, color, PIECE_KING);
+    return king ? bb_lsb(king) : POS_NO_SQUARE;
 }
 
-typedef struct {
-    int from, to;
-    int8_t moved_piece;
-    int8_t captured_piece;
-    uint8_t prev_castling;
-    int8_t prev_en_passant;
-    uint16_t prev_halfmove;
-    uint32_t prev_fullmove;
-    int ep_capture_sq;
-} Undo;
-
-static void make_move_raw(Position *pos, int from, int to, int promotion, Undo *undo)
+static inline void put_piece(Position *pos, int sq, int8_t v)
 {
-    assert(from >= 0 && from < 64 && to >= 0 && to < 64);
+    Bitboard b = BB_SQUARE(sq);
+    pos->board[sq] = v;
+    pos->type_bb[piece_abs(v)] |= b;
+    pos->color_bb[v < 0] |= b;
+    eval_add_piece(pos, sq, v);
+    if (pos->nnue) nnue_add_piece(pos, sq, v);
+}
+
+static inline void remove_piece(Position *pos, int sq)
+{
+    int8_t v = pos->board[sq];
+    if (v == PIECE_EMPTY) return;
+    Bitboard b = BB_SQUARE(sq);
+    pos->board[sq] = PIECE_EMPTY;
+    pos->type_bb[piece_abs(v)] &= ~b;
+    pos->color_bb[v < 0] &= ~b;
+    eval_remove_piece(pos, sq, v);
+    if (pos->nnue) nnue_remove_piece(pos, sq, v);
+}
+
+static inline void move_piece(Position *pos, int from, int to)
+{
+    int8_t v = pos->board[from];
+    Bitboard b = BB_SQUARE(from) | BB_SQUARE(to);
+    pos->board[to] = v;
+    pos->board[from] = PIECE_EMPTY;
+    pos->type_bb[piece_abs(v)] ^= b;
+    pos->color_bb[v < 0] ^= b;
+    eval_move_piece(pos, from, to, v);
+    if (pos->nnue) nnue_move_piece(pos, from, to, v);
+}
+
+typedef MoveUndo Undo;
+
+static const uint8_t castle_clear[64] = {
+    [0]  = CASTLE_WHITE_Q, [4]  = CASTLE_WHITE_K | CASTLE_WHITE_Q, [7]  = CASTLE_WHITE_K,
+    [56] = CASTLE_BLACK_Q, [60] = CASTLE_BLACK_K | CASTLE_BLACK_Q, [63] = CASTLE_BLACK_K,
+};
+
+static void make_move_raw(Position *pos, Move move, Undo *undo)
+{
+    int from = move_from(move), to = move_to(move), flag = move_flag(move);
+    int8_t piece = pos->board[from];
+    uint64_t key = pos->hash, pawn_key = pos->pawn_key;
     undo->from = from;
     undo->to = to;
-    undo->moved_piece = pos->board[from];
+    undo->move = move;
+    undo->moved_piece = piece;
     undo->captured_piece = pos->board[to];
     undo->prev_castling = pos->castling;
     undo->prev_en_passant = pos->en_passant;
     undo->prev_halfmove = pos->halfmove_clock;
     undo->prev_fullmove = pos->fullmove_number;
+    undo->prev_hash = key;
+    undo->prev_pawn_key = pawn_key;
     undo->ep_capture_sq = POS_NO_SQUARE;
-    pos->board[to] = pos->board[from];
-    pos->board[from] = PIECE_EMPTY;
-    if (promotion != 0) {
-        int8_t sign = (undo->moved_piece > 0) ? 1 : -1;
-        pos->board[to] = (int8_t)(sign * promotion);
+    if (pos->nnue) {
+        pos->nnue[1] = pos->nnue[0];
+        pos->nnue++;
+    }
+
+    if (flag == MOVE_FLAG_EN_PASSANT) {
+        int cap_sq = to + (piece > 0 ? -8 : 8);
+        undo->captured_piece = pos->board[cap_sq];
+        undo->ep_capture_sq = cap_sq;
+        key ^= zobrist_piece_key(undo->captured_piece, cap_sq);
+        pawn_key ^= zobrist_piece_key(undo->captured_piece, cap_sq);
+        remove_piece(pos, cap_sq);
+    } else if (undo->captured_piece != PIECE_EMPTY) {
+        key ^= zobrist_piece_key(undo->captured_piece, to);
+        if (piece_abs(undo->captured_piece) == PIECE_PAWN) pawn_key ^= zobrist_piece_key(undo->captured_piece, to);
+        remove_piece(pos, to);
     }
-    if (piece_abs(undo->moved_piece) == PIECE_PAWN || undo->captured_piece != PIECE_EMPTY) {
+    move_piece(pos, from, to);
+    key ^= zobrist_piece_key(piece, from) ^ zobrist_piece_key(piece, to);
+    int is_pawn = piece_abs(piece) == PIECE_PAWN;
+    if (is_pawn) pawn_key ^= zobrist_piece_key(piece, from) ^ zobrist_piece_key(piece, to);
+    if (flag == MOVE_FLAG_PROMOTION) {
+        int8_t promoted = (int8_t)((piece > 0 ? 1 : -1) * move_promotion(move));
+        remove_piece(pos, to);
+        put_piece(pos, to, promoted);
+        key ^= zobrist_piece_key(piece, to) ^ zobrist_piece_key(promoted, to);
+        pawn_key ^= zobrist_piece_key(piece, to);
+    } else if (flag == MOVE_FLAG_CASTLING) {
+        int rank = rank_of(from);
+        int rook_from = to > from ? SQ_INDEX(7, rank) : SQ_INDEX(0, rank);
+        int rook_to   = to > from ? SQ_INDEX(5, rank) : SQ_INDEX(3, rank);
+        int8_t rook = pos->board[rook_from];
+        move_piece(pos, rook_from, rook_to);
+        key ^= zobrist_piece_key(rook, rook_from) ^ zobrist_piece_key(rook, rook_to);
+    }
+
+    if (is_pawn || undo->captured_piece != PIECE_EMPTY) {
         pos->halfmove_clock = 0;
     } else {
         pos->halfmove_clock++;
     }
+    if (pos->en_passant != POS_NO_SQUARE) key ^= zobrist_ep_file[file_of(pos->en_passant)];
     pos->en_passant = POS_NO_SQUARE;
-    if (piece_abs(undo->moved_piece) == PIECE_PAWN) {
-        int fr = rank_of(from), tr = rank_of(to);
-        if (abs(tr - fr) == 2) {
-            int ep_rank = (fr + tr) / 2;
-            int ep_file = file_of(from);
-            pos->en_passant = SQ_INDEX(ep_file, ep_rank);
-        }
-        if (undo->captured_piece == PIECE_EMPTY && file_of(from) != file_of(to)) {
-            if (undo->prev_en_passant != POS_NO_SQUARE && undo->prev_en_passant == to) {
-                int dir = (undo->moved_piece > 0) ? -1 : 1;
-                int cap_sq = SQ_INDEX(file_of(to), rank_of(to) + dir);
-                if (cap_sq >= 0 && cap_sq < 64) {
-                    undo->captured_piece = pos->board[cap_sq];
-                    undo->ep_capture_sq = cap_sq;
-                    pos->board[cap_sq] = PIECE_EMPTY;
-                }
-            }
-        }
-    }
-    if (piece_abs(undo->moved_piece) == PIECE_KING) {
-        int ffile = file_of(from), tfile = file_of(to), frank = rank_of(from);
-        if (abs(tfile - ffile) == 2) {
-            if (tfile > ffile) {
-                int rook_from = SQ_INDEX(7, frank);
-                int rook_to   = SQ_INDEX(5, frank);
-                pos->board[rook_to] = pos->board[rook_from];
-                pos->board[rook_from] = PIECE_EMPTY;
-            } else {
-                int rook_from = SQ_INDEX(0, frank);
-                int rook_to   = SQ_INDEX(3, frank);
-                pos->board[rook_to] = pos->board[rook_from];
-                pos->board[rook_from] = PIECE_EMPTY;
-            }
-        }
-        if (undo->moved_piece > 0) {
-            pos->castling &= ~(CASTLE_WHITE_K | CASTLE_WHITE_Q);
-        } else {
-            pos->castling &= ~(CASTLE_BLACK_K | CASTLE_BLACK_Q);
-        }
-    }
-    if (piece_abs(undo->moved_piece) == PIECE_ROOK) {
-        if (undo->moved_piece > 0) {
-            if (from == SQ_INDEX(0,0)) pos->castling &= ~CASTLE_WHITE_Q;
-            if (from == SQ_INDEX(7,0)) pos->castling &= ~CASTLE_WHITE_K;
-        } else {
-            if (from == SQ_INDEX(0,7)) pos->castling &= ~CASTLE_BLACK_Q;
-            if (from == SQ_INDEX(7,7)) pos->castling &= ~CASTLE_BLACK_K;
-        }
-    }
-    if (undo->captured_piece != PIECE_EMPTY && piece_abs(undo->captured_piece) == PIECE_ROOK) {
-        if (undo->captured_piece > 0) {
-            if (to == SQ_INDEX(0,0)) pos->castling &= ~CASTLE_WHITE_Q;
-            if (to == SQ_INDEX(7,0)) pos->castling &= ~CASTLE_WHITE_K;
-        } else {
-            if (to == SQ_INDEX(0,7)) pos->castling &= ~CASTLE_BLACK_Q;
-            if (to == SQ_INDEX(7,7)) pos->castling &= ~CASTLE_BLACK_K;
-        }
+    if (is_pawn && abs(to - from) == 16) {
+        pos->en_passant = (int8_t)((from + to) / 2);
+        key ^= zobrist_ep_file[file_of(from)];
     }
+    uint8_t castling = pos->castling & (uint8_t)~(castle_clear[from] | castle_clear[to]);
+    key ^= zobrist_castling[pos->castling] ^ zobrist_castling[castling];
+    pos->castling = castling;
     pos->side_to_move = (pos->side_to_move == COLOR_WHITE) ? COLOR_BLACK : COLOR_WHITE;
     if (pos->side_to_move == COLOR_WHITE) pos->fullmove_number++;
+    pos->hash = key ^ zobrist_side;
+    pos->pawn_key = pawn_key;
+#ifdef CHECK_HASH
+    assert(pos->hash == zobrist_compute(pos));
+    assert(pos->pawn_key == zobrist_compute_pawns(pos));
+#endif
 }
 
 static void unmake_move_raw(Position *pos, const Undo *undo)
 {
+    /* the entry below the top still holds the sums from before the move */
+    NNUEAccumulator *nnue = pos->nnue;
+    pos->nnue = NULL;
     pos->side_to_move = (pos->side_to_move == COLOR_WHITE) ? COLOR_BLACK : COLOR_WHITE;
     pos->fullmove_number = undo->prev_fullmove;
     pos->halfmove_clock = undo->prev_halfmove;
     pos->castling = undo->prev_castling;
     pos->en_passant = undo->prev_en_passant;
-    pos->board[undo->from] = undo->moved_piece;
+    pos->hash = undo->prev_hash;
+    pos->pawn_key = undo->prev_pawn_key;
+    if (move_flag(undo->move) == MOVE_FLAG_CASTLING) {
+        int rank = rank_of(undo->from);
+        if (undo->to > undo->from) move_piece(pos, SQ_INDEX(5, rank), SQ_INDEX(7, rank));
+        else                       move_piece(pos, SQ_INDEX(3, rank), SQ_INDEX(0, rank));
+    }
+    remove_piece(pos, undo->to);
+    put_piece(pos, undo->from, undo->moved_piece);
     if (undo->ep_capture_sq != POS_NO_SQUARE) {
-        pos->board[undo->to] = PIECE_EMPTY;
-        pos->board[undo->ep_capture_sq] = undo->captured_piece;
+        put_piece(pos, undo->ep_capture_sq, undo->captured_piece);
+    } else if (undo->captured_piece != PIECE_EMPTY) {
+        put_piece(pos, undo->to, undo->captured_piece);
+    }
+    pos->nnue = nnue ? nnue - 1 : NULL;
+#ifdef CHECK_HASH
+    assert(pos->hash == zobrist_compute(pos));
+    assert(pos->pawn_key == zobrist_compute_pawns(pos));
+#endif
+}
+
+static inline void list_add(MoveList *list, int from, int to, int flag)
+{
+    list->moves[list->count++] = move_encode(from, to, 0, flag);
+}
+
+static inline void list_add_pawn(MoveList *list, int from, int to)
+{
+    int rank = rank_of(to);
+    if (rank == 0 || rank == 7) {
+        list->moves[list->count++] = move_encode(from, to, PIECE_QUEEN, MOVE_FLAG_PROMOTION);
+        list->moves[list->count++] = move_encode(from, to, PIECE_ROOK, MOVE_FLAG_PROMOTION);
+        list->moves[list->count++] = move_encode(from, to, PIECE_BISHOP, MOVE_FLAG_PROMOTION);
+        list->moves[list->count++] = move_encode(from, to, PIECE_KNIGHT, MOVE_FLAG_PROMOTION);
     } else {
-        pos->board[undo->to]   = undo->captured_piece;
+        list->moves[list->count++] = move_encode(from, to, 0, MOVE_FLAG_NORMAL);
     }
-    if (piece_abs(undo->moved_piece) == PIECE_KING) {
-        int ffile = file_of(undo->from), tfile = file_of(undo->to), frank = rank_of(undo->from);
-        if (abs(tfile - ffile) == 2) {
-            if (tfile > ffile) {
-                int rook_from = SQ_INDEX(7, frank);
-                int rook_to   = SQ_INDEX(5, frank);
-                pos->board[rook_from] = pos->board[rook_to];
-                pos->board[rook_to] = PIECE_EMPTY;
-            } else {
-                int rook_from = SQ_INDEX(0, frank);
-                int rook_to   = SQ_INDEX(3, frank);
-                pos->board[rook_from] = pos->board[rook_to];
-                pos->board[rook_to] = PIECE_EMPTY;
-            }
-        }
+}
+
+static void list_add_pawn_set(MoveList *list, Bitboard targets, int delta)
+{
+    while (targets) {
+        int to = bb_pop_lsb(&targets);
+        list_add_pawn(list, to - delta, to);
     }
 }
 
-static int generate_pseudo_moves(Position *pos, int *from_out, int *to_out, int *promo_out, int capacity)
-{
-    int n = 0;
-    int stm = pos->side_to_move;
-    for (int sq = 0; sq < 64; ++sq) {
-        int8_t v = pos->board[sq];
-        if (v == PIECE_EMPTY) continue;
-        int color = v > 0 ? COLOR_WHITE : COLOR_BLACK;
-        if (color != stm) continue;
-        int abs_v = piece_abs(v);
-        int f = file_of(sq), r = rank_of(sq);
-        if (abs_v == PIECE_PAWN) {
-            int dir = (color == COLOR_WHITE) ? 1 : -1;
-            int tr = r + dir;
-            if (tr >= 0 && tr <= 7) {
-                int tsq = SQ_INDEX(f, tr);
-                if (pos->board[tsq] == PIECE_EMPTY) {
-                    if ((color == COLOR_WHITE && tr == 7) || (color == COLOR_BLACK && tr == 0)) {
-                        int promos[4] = { PIECE_QUEEN, PIECE_ROOK, PIECE_BISHOP, PIECE_KNIGHT };
-                        for (int pi = 0; pi < 4; ++pi) {
-                            if (n < capacity) { from_out[n]=sq; to_out[n]=tsq; promo_out[n]=promos[pi]; n++; }
-                        }
-                    } else {
-                        if (n < capacity) { from_out[n]=sq; to_out[n]=tsq; promo_out[n]=0; n++; }
-                        if ((color == COLOR_WHITE && r == 1) || (color == COLOR_BLACK && r == 6)) {
-                            int tr2 = r + 2*dir;
-                            int tsq2 = SQ_INDEX(f, tr2);
-                            if (pos->board[tsq2] == PIECE_EMPTY) {
-                                if (n < capacity) { from_out[n]=sq; to_out[n]=tsq2; promo_out[n]=0; n++; }
-                            }
-                        }
-                    }
-                }
-            }
-            for (int df = -1; df <= 1; df += 2) {
-                int ff = f + df;
-                int rr = r + dir;
-                if (ff < 0 || ff > 7 || rr < 0 || rr > 7) continue;
-                int tsq = SQ_INDEX(ff, rr);
-                int8_t target = pos->board[tsq];
-                if (target != PIECE_EMPTY && ((target > 0) != (v > 0))) {
-                    if ((color == COLOR_WHITE && rr == 7) || (color == COLOR_BLACK && rr == 0)) {
-                        int promos[4] = { PIECE_QUEEN, PIECE_ROOK, PIECE_BISHOP, PIECE_KNIGHT };
-                        for (int pi = 0; pi < 4; ++pi) {
-                            if (n < capacity) { from_out[n]=sq; to_out[n]=tsq; promo_out[n]=promos[pi]; n++; }
-                        }
-                    } else {
-                        if (n < capacity) { from_out[n]=sq; to_out[n]=tsq; promo_out[n]=0; n++; }
-                    }
-                }
-                if (pos->en_passant != POS_NO_SQUARE && tsq == pos->en_passant) {
-                    if (n < capacity) { from_out[n]=sq; to_out[n]=tsq; promo_out[n]=0; n++; }
-                }
-            }
-        } else if (abs_v == PIECE_KNIGHT) {
-            const int kd[8][2] = {{2,1},{1,2},{-1,2},{-2,1},{-2,-1},{-1,-2},{1,-2},{2,-1}};
-            for (int i=0;i<8;++i) {
-                int ff=f+kd[i][0], rr=r+kd[i][1];
-                if (ff<0||ff>7||rr<0||rr>7) continue;
-                int tsq = SQ_INDEX(ff, rr);
-                int8_t t = pos->board[tsq];
-                if (t == PIECE_EMPTY || ((t>0)!=(v>0))) {
-                    if (n < capacity) { from_out[n]=sq; to_out[n]=tsq; promo_out[n]=0; n++; }
-                }
-            }
-        } else if (abs_v == PIECE_BISHOP || abs_v == PIECE_ROOK || abs_v == PIECE_QUEEN) {
-            int dirs_local[8][2];
-            int dir_count = 0;
-            if (abs_v == PIECE_BISHOP) { int d[4][2]={{1,1},{1,-1},{-1,1},{-1,-1}}; memcpy(dirs_local,d,sizeof d); dir_count=4; }
-            else if (abs_v == PIECE_ROOK) { int d[4][2]={{1,0},{-1,0},{0,1},{0,-1}}; memcpy(dirs_local,d,sizeof d); dir_count=4; }
-            else { int d[8][2]={{1,0},{-1,0},{0,1},{0,-1},{1,1},{1,-1},{-1,1},{-1,-1}}; memcpy(dirs_local,d,sizeof d); dir_count=8; }
-            for (int di=0; di<dir_count; ++di) {
-                int df = dirs_local[di][0], dr = dirs_local[di][1];
-                int ff = f+df, rr = r+dr;
-                while (ff>=0 && ff<=7 && rr>=0 && rr<=7) {
-                    int tsq = SQ_INDEX(ff, rr);
-                    int8_t t = pos->board[tsq];
-                    if (t == PIECE_EMPTY) {
-                        if (n < capacity) { from_out[n]=sq; to_out[n]=tsq; promo_out[n]=0; n++; }
-                    } else {
-                        if ((t>0)!=(v>0)) {
-                            if (n < capacity) { from_out[n]=sq; to_out[n]=tsq; promo_out[n]=0; n++; }
-                        }
-                        break;
-                    }
-                    ff += df; rr += dr;
-                }
-            }
-        } else if (abs_v == PIECE_KING) {
-            for (int df=-1; df<=1; ++df) for (int dr=-1; dr<=1; ++dr) {
-                if (df==0 && dr==0) continue;
-                int ff=f+df, rr=r+dr;
-                if (ff<0||ff>7||rr<0||rr>7) continue;
-                int tsq = SQ_INDEX(ff, rr);
-                int8_t t = pos->board[tsq];
-                if (t == PIECE_EMPTY || ((t>0)!=(v>0))) {
-                    if (n < capacity) { from_out[n]=sq; to_out[n]=tsq; promo_out[n]=0; n++; }
-                }
-            }
-            if (v > 0) {
-                int e1 = SQ_INDEX(4,0), f1 = SQ_INDEX(5,0), g1 = SQ_INDEX(6,0), d1 = SQ_INDEX(3,0), c1 = SQ_INDEX(2,0), b1 = SQ_INDEX(1,0);
-                if (pos->castling & CASTLE_WHITE_K) {
-                    int rook_from = SQ_INDEX(7,0);
-                    if (pos->board[rook_from] == PIECE_ROOK &&
-                        pos->board[f1]==PIECE_EMPTY && pos->board[g1]==PIECE_EMPTY) {
-                        if (!is_square_attacked(pos, e1, COLOR_BLACK) &&
-                            !is_square_attacked(pos, f1, COLOR_BLACK) &&
-                            !is_square_attacked(pos, g1, COLOR_BLACK)) {
-                            if (n < capacity) { from_out[n]=sq; to_out[n]=g1; promo_out[n]=0; n++; }
-                        }
-                    }
-                }
-                if (pos->castling & CASTLE_WHITE_Q) {
-                    int rook_from = SQ_INDEX(0,0);
-                    if (pos->board[rook_from] == PIECE_ROOK &&
-                        pos->board[b1]==PIECE_EMPTY && pos->board[c1]==PIECE_EMPTY && pos->board[d1]==PIECE_EMPTY) {
-                        if (!is_square_attacked(pos, e1, COLOR_BLACK) &&
-                            !is_square_attacked(pos, d1, COLOR_BLACK) &&
-                            !is_square_attacked(pos, c1, COLOR_BLACK)) {
-                            if (n < capacity) { from_out[n]=sq; to_out[n]=c1; promo_out[n]=0; n++; }
-                        }
-                    }
-                }
-            } else {
-                int e8 = SQ_INDEX(4,7), f8 = SQ_INDEX(5,7), g8 = SQ_INDEX(6,7), d8 = SQ_INDEX(3,7), c8 = SQ_INDEX(2,7), b8 = SQ_INDEX(1,7);
-                if (pos->castling & CASTLE_BLACK_K) {
-                    int rook_from = SQ_INDEX(7,7);
-                    if (pos->board[rook_from] == -PIECE_ROOK &&
-                        pos->board[f8]==PIECE_EMPTY && pos->board[g8]==PIECE_EMPTY) {
-                        if (!is_square_attacked(pos, e8, COLOR_WHITE) &&
-                            !is_square_attacked(pos, f8, COLOR_WHITE) &&
-                            !is_square_attacked(pos, g8, COLOR_WHITE)) {
-                            if (n < capacity) { from_out[n]=sq; to_out[n]=g8; promo_out[n]=0; n++; }
-                        }
-                    }
-                }
-                if (pos->castling & CASTLE_BLACK_Q) {
-                    int rook_from = SQ_INDEX(0,7);
-                    if (pos->board[rook_from] == -PIECE_ROOK &&
-                        pos->board[b8]==PIECE_EMPTY && pos->board[c8]==PIECE_EMPTY && pos->board[d8]==PIECE_EMPTY) {
-                        if (!is_square_attacked(pos, e8, COLOR_WHITE) &&
-                            !is_square_attacked(pos, d8, COLOR_WHITE) &&
-                            !is_square_attacked(pos, c8, COLOR_WHITE)) {
-                            if (n < capacity) { from_out[n]=sq; to_out[n]=c8; promo_out[n]=0; n++; }
-                        }
-                    }
-                }
-            }
-        }
+static Bitboard attackers_to(const Position *pos, int sq, Bitboard occ)
+{
+    Bitboard queens = pos->type_bb[PIECE_QUEEN];
+    return (bb_pawn_attacks[COLOR_BLACK][sq] & position_pieces(pos, COLOR_WHITE, PIECE_PAWN)) |
+           (bb_pawn_attacks[COLOR_WHITE][sq] & position_pieces(pos, COLOR_BLACK, PIECE_PAWN)) |
+           (bb_knight_attacks[sq] & pos->type_bb[PIECE_KNIGHT]) |
+           (bb_king_attacks[sq] & pos->type_bb[PIECE_KING]) |
+           (bb_rook_attacks(sq, occ) & (pos->type_bb[PIECE_ROOK] | queens)) |
+           (bb_bishop_attacks(sq, occ) & (pos->type_bb[PIECE_BISHOP] | queens));
+}
+
+static Bitboard pinned_pieces(const Position *pos, int us, int ksq)
+{
+    Bitboard them_bb = pos->color_bb[us ^ 1];
+    Bitboard occ = position_occupied(pos);
+    Bitboard queens = pos->type_bb[PIECE_QUEEN];
+    Bitboard snipers = ((bb_rook_attacks(ksq, them_bb) & (pos->type_bb[PIECE_ROOK] | queens)) |
+                        (bb_bishop_attacks(ksq, them_bb) & (pos->type_bb[PIECE_BISHOP] | queens))) & them_bb;
+    Bitboard pinned = BB_EMPTY;
+    while (snipers) {
+        int s = bb_pop_lsb(&snipers);
+        Bitboard blockers = bb_between[ksq][s] & occ;
+        if (blockers && !(blockers & (blockers - 1))) pinned |= blockers;
     }
-    return n;
+    return pinned & pos->color_bb[us];
 }
 
-int generate_legal_moves(Position *pos, int *moves_from, int *moves_to, int *promotions, int capacity)
+static int en_passant_is_legal(const Position *pos, int from, int ksq)
 {
-    int tmp_cap = 512;
-    int *from = (int*)malloc(sizeof(int)*tmp_cap);
-    int *to   = (int*)malloc(sizeof(int)*tmp_cap);
-    int *prom = (int*)malloc(sizeof(int)*tmp_cap);
-    if (!from || !to || !prom) { free(from); free(to); free(prom); return 0; }
-    int cnt = generate_pseudo_moves(pos, from, to, prom, tmp_cap);
-    int out = 0;
-    Undo undo;
-    for (int i = 0; i < cnt; ++i) {
-        make_move_raw(pos, from[i], to[i], prom[i], &undo);
-        int moved_color = (undo.moved_piece > 0) ? COLOR_WHITE : COLOR_BLACK;
-        int king_sq = find_king_sq(pos, moved_color);
-        int illegal = 0;
-        if (king_sq == POS_NO_SQUARE) illegal = 1;
-        else {
-            int attacker = (moved_color == COLOR_WHITE) ? COLOR_BLACK : COLOR_WHITE;
-            if (is_square_attacked(pos, king_sq, attacker)) illegal = 1;
+    int us = pos->side_to_move, them = us ^ 1;
+    int to = pos->en_passant;
+    int cap_sq = (us == COLOR_WHITE) ? to - 8 : to + 8;
+    Bitboard occ = (position_occupied(pos) ^ BB_SQUARE(from) ^ BB_SQUARE(cap_sq)) | BB_SQUARE(to);
+    Bitboard attackers = attackers_to(pos, ksq, occ) & pos->color_bb[them] & ~BB_SQUARE(cap_sq);
+    return attackers == BB_EMPTY;
+}
+
+typedef struct {
+    int us, them, ksq;
+    Bitboard us_bb, them_bb, occ;
+    Bitboard checkers, pinned, target;
+} GenState;
+
+typedef struct {
+    int up;
+    Bitboard push1, push2, west, east;
+} PawnSets;
+
+#define BB_PROMOTION_RANKS (BB_RANK_1 | BB_RANK_8)
+
+static int gen_init(const Position *pos, GenState *st)
+{
+    st->us = pos->side_to_move;
+    st->them = st->us ^ 1;
+    st->us_bb = pos->color_bb[st->us];
+    st->them_bb = pos->color_bb[st->them];
+    st->occ = st->us_bb | st->them_bb;
+    st->ksq = find_king_sq(pos, st->us);
+    if (st->ksq == POS_NO_SQUARE) return 0;
+    st->checkers = attackers_to(pos, st->ksq, st->occ) & st->them_bb;
+    st->target = ~st->us_bb;
+    if (st->checkers) st->target = bb_between[st->ksq][bb_lsb(st->checkers)] | st->checkers;
+    st->pinned = pinned_pieces(pos, st->us, st->ksq);
+    return 1;
+}
+
+static inline int gen_double_check(const GenState *st)
+{
+    return (st->checkers & (st->checkers - 1)) != 0;
+}
+
+static Bitboard king_targets(const Position *pos, const GenState *st)
+{
+    Bitboard candidates = bb_king_attacks[st->ksq] & ~st->us_bb;
+    Bitboard occ_no_king = st->occ ^ BB_SQUARE(st->ksq);
+    Bitboard legal = BB_EMPTY;
+    while (candidates) {
+        int to = bb_pop_lsb(&candidates);
+        if (!(attackers_to(pos, to, occ_no_king) & st->them_bb)) legal |= BB_SQUARE(to);
+    }
+    return legal;
+}
+
+static void pawn_sets(const Position *pos, const GenState *st, PawnSets *ps)
+{
+    Bitboard pawns = position_pieces(pos, st->us, PIECE_PAWN) & ~st->pinned;
+    Bitboard double_rank = (st->us == COLOR_WHITE) ? BB_RANK_3 : BB_RANK_6;
+    ps->up = (st->us == COLOR_WHITE) ? 8 : -8;
+    Bitboard push1 = bb_shift(pawns, ps->up) & ~st->occ;
+    ps->push1 = push1 & st->target;
+    ps->push2 = bb_shift(push1 & double_rank, ps->up) & ~st->occ & st->target;
+    ps->west = bb_shift(pawns & ~BB_FILE_A, ps->up - 1) & st->them_bb & st->target;
+    ps->east = bb_shift(pawns & ~BB_FILE_H, ps->up + 1) & st->them_bb & st->target;
+}
+
+static Bitboard pinned_pawn_targets(const GenState *st, int from)
+{
+    int up = (st->us == COLOR_WHITE) ? 8 : -8;
+    Bitboard double_rank = (st->us == COLOR_WHITE) ? BB_RANK_3 : BB_RANK_6;
+    Bitboard dests = bb_pawn_attacks[st->us][from] & st->them_bb;
+    Bitboard push1 = bb_shift(BB_SQUARE(from), up) & ~st->occ;
+    dests |= push1 | (bb_shift(push1 & double_rank, up) & ~st->occ);
+    return dests & bb_line[st->ksq][from];
+}
+
+static Bitboard piece_targets(const Position *pos, const GenState *st, int from)
+{
+    Bitboard attacks;
+    switch (piece_abs(pos->board[from])) {
+    case PIECE_KNIGHT: attacks = bb_knight_attacks[from]; break;
+    case PIECE_BISHOP: attacks = bb_bishop_attacks(from, st->occ); break;
+    case PIECE_ROOK:   attacks = bb_rook_attacks(from, st->occ); break;
+    case PIECE_QUEEN:  attacks = bb_queen_attacks(from, st->occ); break;
+    default:           attacks = BB_EMPTY; break;
+    }
+    attacks &= st->target;
+    if (st->pinned & BB_SQUARE(from)) attacks &= bb_line[st->ksq][from];
+    return attacks;
+}
+
+static Bitboard castling_targets(const Position *pos, const GenState *st)
+{
+    int rank = (st->us == COLOR_WHITE) ? 0 : 7;
+    int king_sq = SQ_INDEX(4, rank);
+    int8_t rook = (st->us == COLOR_WHITE) ? PIECE_ROOK : -PIECE_ROOK;
+    uint8_t rights_k = (st->us == COLOR_WHITE) ? CASTLE_WHITE_K : CASTLE_BLACK_K;
+    uint8_t rights_q = (st->us == COLOR_WHITE) ? CASTLE_WHITE_Q : CASTLE_BLACK_Q;
+    Bitboard targets = BB_EMPTY;
+    if (st->checkers || !(pos->castling & (rights_k | rights_q)) || st->ksq != king_sq) return targets;
+    if ((pos->castling & rights_k) && pos->board[SQ_INDEX(7, rank)] == rook &&
+        !(st->occ & bb_between[king_sq][SQ_INDEX(7, rank)]) &&
+        !is_square_attacked(pos, SQ_INDEX(5, rank), st->them) &&
+        !is_square_attacked(pos, SQ_INDEX(6, rank), st->them)) {
+        targets |= BB_SQUARE(SQ_INDEX(6, rank));
+    }
+    if ((pos->castling & rights_q) && pos->board[SQ_INDEX(0, rank)] == rook &&
+        !(st->occ & bb_between[king_sq][SQ_INDEX(0, rank)]) &&
+        !is_square_attacked(pos, SQ_INDEX(3, rank), st->them) &&
+        !is_square_attacked(pos, SQ_INDEX(2, rank), st->them)) {
+        targets |= BB_SQUARE(SQ_INDEX(2, rank));
+    }
+    return targets;
+}
+
+enum { GEN_ALL, GEN_TACTICAL, GEN_QUIET };
+
+/* GEN_TACTICAL: captures, en passant and promotions (no quiet evasions even in check).
+ * GEN_QUIET: everything else, castling included. */
+static inline void generate_moves(const Position *pos, MoveList *list, int mode)
+{
+    GenState st;
+    if (!gen_init(pos, &st)) return;
+    Bitboard capture_mask = mode == GEN_TACTICAL ? st.them_bb : mode == GEN_QUIET ? ~st.them_bb : ~BB_EMPTY;
+    Bitboard pawn_mask = mode == GEN_TACTICAL ? st.them_bb | BB_PROMOTION_RANKS :
+                         mode == GEN_QUIET ? ~(st.them_bb | BB_PROMOTION_RANKS) : ~BB_EMPTY;
+
+    Bitboard targets = king_targets(pos, &st) & capture_mask;
+    while (targets) list_add(list, st.ksq, bb_pop_lsb(&targets), MOVE_FLAG_NORMAL);
+    if (gen_double_check(&st)) return;
+
+    PawnSets ps;
+    pawn_sets(pos, &st, &ps);
+    list_add_pawn_set(list, ps.push1 & pawn_mask, ps.up);
+    if (mode != GEN_TACTICAL) list_add_pawn_set(list, ps.push2, 2 * ps.up);
+    if (mode != GEN_QUIET) {
+        list_add_pawn_set(list, ps.west, ps.up - 1);
+        list_add_pawn_set(list, ps.east, ps.up + 1);
+    }
+    Bitboard pawns = position_pieces(pos, st.us, PIECE_PAWN);
+    if (!st.checkers) {
+        Bitboard pinned_pawns = pawns & st.pinned;
+        while (pinned_pawns) {
+            int from = bb_pop_lsb(&pinned_pawns);
+            Bitboard dests = pinned_pawn_targets(&st, from) & pawn_mask;
+            while (dests) list_add_pawn(list, from, bb_pop_lsb(&dests));
         }
-        unmake_move_raw(pos, &undo);
-        if (!illegal) {
-            if (out < capacity) {
-                moves_from[out] = from[i];
-                moves_to[out] = to[i];
-                promotions[out] = prom[i];
-            }
-            out++;
+    }
+    if (mode != GEN_QUIET && pos->en_passant != POS_NO_SQUARE) {
+        Bitboard ep_pawns = bb_pawn_attacks[st.them][pos->en_passant] & pawns;
+        while (ep_pawns) {
+            int from = bb_pop_lsb(&ep_pawns);
+            if (en_passant_is_legal(pos, from, st.ksq)) list_add(list, from, pos->en_passant, MOVE_FLAG_EN_PASSANT);
         }
     }
-    free(from); free(to); free(prom);
-    return out;
+
+    Bitboard pieces = st.us_bb & ~pawns & ~pos->type_bb[PIECE_KING];
+    while (pieces) {
+        int from = bb_pop_lsb(&pieces);
+        Bitboard attacks = piece_targets(pos, &st, from) & capture_mask;
+        while (attacks) list_add(list, from, bb_pop_lsb(&attacks), MOVE_FLAG_NORMAL);
+    }
+
+    if (mode == GEN_TACTICAL) return;
+    targets = castling_targets(pos, &st);
+    while (targets) list_add(list, st.ksq, bb_pop_lsb(&targets), MOVE_FLAG_CASTLING);
+}
+
+static inline int count_pawn_targets(Bitboard targets)
+{
+    return bb_popcount(targets & ~BB_PROMOTION_RANKS) + 4 * bb_popcount(targets & BB_PROMOTION_RANKS);
+}
+
+int count_legal_moves(const Position *pos)
+{
+    GenState st;
+    if (!gen_init(pos, &st)) return 0;
+
+    int n = bb_popcount(king_targets(pos, &st));
+    if (gen_double_check(&st)) return n;
+
+    PawnSets ps;
+    pawn_sets(pos, &st, &ps);
+    n += count_pawn_targets(ps.push1) + bb_popcount(ps.push2) +
+         count_pawn_targets(ps.west) + count_pawn_targets(ps.east);
+    Bitboard pawns = position_pieces(pos, st.us, PIECE_PAWN);
+    if (!st.checkers) {
+        Bitboard pinned_pawns = pawns & st.pinned;
+        while (pinned_pawns) n += count_pawn_targets(pinned_pawn_targets(&st, bb_pop_lsb(&pinned_pawns)));
+    }
+    if (pos->en_passant != POS_NO_SQUARE) {
+        Bitboard ep_pawns = bb_pawn_attacks[st.them][pos->en_passant] & pawns;
+        while (ep_pawns) n += en_passant_is_legal(pos, bb_pop_lsb(&ep_pawns), st.ksq);
+    }
+
+    Bitboard pieces = st.us_bb & ~pawns & ~pos->type_bb[PIECE_KING];
+    while (pieces) n += bb_popcount(piece_targets(pos, &st, bb_pop_lsb(&pieces)));
+
+    return n + bb_popcount(castling_targets(pos, &st));
+}
+
+int position_in_check(const Position *pos)
+{
+    int ksq = find_king_sq(pos, pos->side_to_move);
+    return ksq != POS_NO_SQUARE && is_square_attacked(pos, ksq, pos->side_to_move ^ 1);
+}
+
+int generate_legal_list(const Position *pos, MoveList *list)
+{
+    list->count = 0;
+    generate_moves(pos, list, GEN_ALL);
+    return list->count;
+}
+
+int generate_tactical_list(const Position *pos, MoveList *list)
+{
+    list->count = 0;
+    generate_moves(pos, list, GEN_TACTICAL);
+    return list->count;
+}
+
+int generate_quiet_list(const Position *pos, MoveList *list)
+{
+    list->count = 0;
+    generate_moves(pos, list, GEN_QUIET);
+    return list->count;
+}
+
+static int pawn_move_is_legal(const Position *pos, const GenState *st, Move m)
+{
+    int from = move_from(m), to = move_to(m), flag = move_flag(m);
+    if (flag == MOVE_FLAG_EN_PASSANT)
+        return to == pos->en_passant && (bb_pawn_attacks[st->us][from] & BB_SQUARE(to)) &&
+               en_passant_is_legal(pos, from, st->ksq);
+    if (flag == MOVE_FLAG_CASTLING) return 0;
+    if ((flag == MOVE_FLAG_PROMOTION) != ((BB_SQUARE(to) & BB_PROMOTION_RANKS) != 0)) return 0;
+    if (st->pinned & BB_SQUARE(from))
+        return !st->checkers && (pinned_pawn_targets(st, from) & BB_SQUARE(to));
+    PawnSets ps;
+    pawn_sets(pos, st, &ps);
+    if (to == from + ps.up) return (ps.push1 & BB_SQUARE(to)) != 0;
+    if (to == from + 2 * ps.up) return (ps.push2 & BB_SQUARE(to)) != 0;
+    if (to == from + ps.up - 1 && file_of(from) != 0) return (ps.west & BB_SQUARE(to)) != 0;
+    if (to == from + ps.up + 1 && file_of(from) != 7) return (ps.east & BB_SQUARE(to)) != 0;
+    return 0;
+}
+
+/* Legality of an arbitrary packed move (e.g. from the hash table) without generating the list. */
+int move_is_legal(const Position *pos, Move m)
+{
+    int from = move_from(m), to = move_to(m), flag = move_flag(m);
+    int8_t piece = pos->board[from];
+    if (m == MOVE_NONE || from == to || piece == PIECE_EMPTY || piece_color(piece) != pos->side_to_move) return 0;
+    if (flag == MOVE_FLAG_PROMOTION ? piece_abs(piece) != PIECE_PAWN : (m >> 12) & 3) return 0;
+    GenState st;
+    if (!gen_init(pos, &st)) return 0;
+
+    Bitboard to_bb = BB_SQUARE(to);
+    switch (piece_abs(piece)) {
+    case PIECE_KING:
+        if (flag == MOVE_FLAG_CASTLING) return (castling_targets(pos, &st) & to_bb) != 0;
+        return flag == MOVE_FLAG_NORMAL && (king_targets(pos, &st) & to_bb);
+    case PIECE_PAWN:
+        return !gen_double_check(&st) && pawn_move_is_legal(pos, &st, m);
+    default:
+        return flag == MOVE_FLAG_NORMAL && !gen_double_check(&st) && (piece_targets(pos, &st, from) & to_bb);
+    }
+}
+
+/*
+ * Static exchange evaluation: swap-list over the least valuable attacker of
+ * each side, re-reading slider attacks after every capture so x-rays join in.
+ */
+int see(const Position *pos, Move m)
+{
+    int from = move_from(m), to = move_to(m);
+    int gain[32], d = 0;
+    Bitboard occ = position_occupied(pos) ^ BB_SQUARE(from);
+    int on_square = piece_abs(pos->board[from]);
+    if (move_flag(m) == MOVE_FLAG_EN_PASSANT) {
+        gain[0] = eval_piece_value[PIECE_PAWN];
+        occ ^= BB_SQUARE(pos->side_to_move == COLOR_WHITE ? to - 8 : to + 8);
+    } else {
+        gain[0] = eval_piece_value[piece_abs(pos->board[to])];
+    }
+    if (move_flag(m) == MOVE_FLAG_PROMOTION) {
+        on_square = move_promotion(m);
+        gain[0] += eval_piece_value[on_square] - eval_piece_value[PIECE_PAWN];
+    }
+
+    int side = pos->side_to_move ^ 1;
+    for (;;) {
+        Bitboard attackers = attackers_to(pos, to, occ) & occ;
+        Bitboard ours = attackers & pos->color_bb[side];
+        if (!ours) break;
+        int pt = PIECE_PAWN;
+        while (!(ours & pos->type_bb[pt])) pt++;
+        if (pt == PIECE_KING && (attackers & pos->color_bb[side ^ 1])) break;
+        d++;
+        gain[d] = eval_piece_value[on_square] - gain[d - 1];
+        if ((-gain[d - 1] > gain[d] ? -gain[d - 1] : gain[d]) < 0 || d == 31) break;
+        occ ^= BB_SQUARE(bb_lsb(ours & pos->type_bb[pt]));
+        on_square = pt;
+        side ^= 1;
+    }
+    while (d > 0) {
+        gain[d - 1] = -(-gain[d - 1] > gain[d] ? -gain[d - 1] : gain[d]);
+        d--;
+    }
+    return gain[0];
+}
+
+Move move_from_squares(const Position *pos, int from, int to, int promotion)
+{
+    int8_t piece = pos->board[from];
+    int flag = MOVE_FLAG_NORMAL;
+    if (promotion != 0) {
+        flag = MOVE_FLAG_PROMOTION;
+    } else if (piece_abs(piece) == PIECE_KING && abs(file_of(to) - file_of(from)) == 2) {
+        flag = MOVE_FLAG_CASTLING;
+    } else if (piece_abs(piece) == PIECE_PAWN && file_of(from) != file_of(to) &&
+               pos->board[to] == PIECE_EMPTY && to == pos->en_passant) {
+        flag = MOVE_FLAG_EN_PASSANT;
+    }
+    return move_encode(from, to, promotion, flag);
+}
+
+int generate_legal_moves(Position *pos, int *moves_from, int *moves_to, int *promotions, int capacity)
+{
+    MoveList list;
+    generate_legal_list(pos, &list);
+    for (int i = 0; i < list.count && i < capacity; ++i) {
+        moves_from[i] = move_from(list.moves[i]);
+        moves_to[i] = move_to(list.moves[i]);
+        promotions[i] = move_promotion(list.moves[i]);
+    }
+    return list.count;
 }
 
 uint64_t perft(Position *pos, int depth)
 {
     if (depth == 0) return 1ULL;
-    int max_moves = 512;
-    int *from = (int*)malloc(sizeof(int)*max_moves);
-    int *to   = (int*)malloc(sizeof(int)*max_moves);
-    int *prom = (int*)malloc(sizeof(int)*max_moves);
-    if (!from || !to || !prom) { free(from); free(to); free(prom); return 0; }
-    int n = generate_legal_moves(pos, from, to, prom, max_moves);
-    if (depth == 1) {
-        uint64_t nodes = (uint64_t)n;
-        free(from); free(to); free(prom);
-        return nodes;
-    }
+    MoveList list;
+    if (depth == 1) return (uint64_t)count_legal_moves(pos);
+    generate_legal_list(pos, &list);
     uint64_t nodes = 0;
     Undo undo;
-    for (int i = 0; i < n; ++i) {
-        make_move_raw(pos, from[i], to[i], prom[i], &undo);
+    for (int i = 0; i < list.count; ++i) {
+        make_move_raw(pos, list.moves[i], &undo);
         nodes += perft(pos, depth - 1);
         unmake_move_raw(pos, &undo);
     }
-    free(from); free(to); free(prom);
     return nodes;
 }
 
+void make_move_packed(Position *pos, Move move, MoveUndo *undo)
+{
+    assert(move_from(move) != move_to(move));
+    make_move_raw(pos, move, undo);
+}
+
 void make_move(Position *pos, int from, int to, int promotion, MoveUndo *undo)
 {
-    make_move_raw(pos, from, to, promotion, (Undo *)undo);
+    assert(from >= 0 && from < 64 && to >= 0 && to < 64);
+    make_move_raw(pos, move_from_squares(pos, from, to, promotion), undo);
 }
 
 void unmake_move(Position *pos, const MoveUndo *undo)
 {
-    unmake_move_raw(pos, (const Undo *)undo);
+    unmake_move_raw(pos, undo);
 }
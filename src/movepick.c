@@ -0,0 +1,134 @@
+#include "movegen.h"
+#include "eval.h"
+#include <string.h>
+
+static inline int is_capture(const Position *pos, Move m)
+{
+    return move_flag(m) == MOVE_FLAG_EN_PASSANT || pos->board[move_to(m)] != PIECE_EMPTY;
+}
+
+static inline int mvv_lva(const Position *pos, Move m)
+{
+    int victim = move_flag(m) == MOVE_FLAG_EN_PASSANT ? PIECE_PAWN : piece_abs(pos->board[move_to(m)]);
+    int score = eval_piece_value[victim] * 8 - piece_abs(pos->board[move_from(m)]);
+    if (move_flag(m) == MOVE_FLAG_PROMOTION) score += eval_piece_value[move_promotion(m)];
+    return score;
+}
+
+/* Selection step: swap the best remaining move to the cursor and return it. */
+static Move pick_best(MovePicker *mp)
+{
+    int best = mp->index;
+    for (int i = mp->index + 1; i < mp->list.count; ++i) {
+        if (mp->scores[i] > mp->scores[best]) best = i;
+    }
+    Move m = mp->list.moves[best];
+    int score = mp->scores[best];
+    mp->list.moves[best] = mp->list.moves[mp->index];
+    mp->scores[best] = mp->scores[mp->index];
+    mp->list.moves[mp->index] = m;
+    mp->scores[mp->index] = score;
+    mp->index++;
+    return m;
+}
+
+static void picker_init(MovePicker *mp, const Position *pos, Move hash_move)
+{
+    mp->pos = pos;
+    mp->history = NULL;
+    mp->hash_move = move_is_legal(pos, hash_move) ? hash_move : MOVE_NONE;
+    mp->killers[0] = mp->killers[1] = MOVE_NONE;
+    mp->stage = PICK_HASH;
+    mp->tactical_only = 0;
+    mp->index = 0;
+    mp->bad_count = 0;
+    mp->list.count = 0;
+}
+
+void movepicker_init(MovePicker *mp, const Position *pos, Move hash_move, const Move *killers,
+                     const int32_t *history)
+{
+    picker_init(mp, pos, hash_move);
+    mp->history = history;
+    if (killers) {
+        mp->killers[0] = killers[0];
+        mp->killers[1] = killers[1];
+    }
+}
+
+void movepicker_init_tactical(MovePicker *mp, const Position *pos, Move hash_move)
+{
+    picker_init(mp, pos, hash_move);
+    mp->tactical_only = 1;
+    if (mp->hash_move != MOVE_NONE && !is_capture(pos, mp->hash_move) && move_flag(mp->hash_move) != MOVE_FLAG_PROMOTION)
+        mp->hash_move = MOVE_NONE;
+}
+
+static int killer_usable(const MovePicker *mp, Move m)
+{
+    return m != MOVE_NONE && m != mp->hash_move && move_flag(m) != MOVE_FLAG_PROMOTION &&
+           !is_capture(mp->pos, m) && move_is_legal(mp->pos, m);
+}
+
+Move movepicker_next(MovePicker *mp)
+{
+    for (;;) {
+        switch (mp->stage) {
+        case PICK_HASH:
+            mp->stage = PICK_GEN_CAPTURES;
+            if (mp->hash_move != MOVE_NONE) return mp->hash_move;
+            break;
+        case PICK_GEN_CAPTURES:
+            generate_tactical_list(mp->pos, &mp->list);
+            for (int i = 0; i < mp->list.count; ++i) mp->scores[i] = mvv_lva(mp->pos, mp->list.moves[i]);
+            mp->index = 0;
+            mp->stage = PICK_GOOD_CAPTURES;
+            break;
+        case PICK_GOOD_CAPTURES:
+            while (mp->index < mp->list.count) {
+                Move m = pick_best(mp);
+                if (m == mp->hash_move) continue;
+                if (see(mp->pos, m) < 0) {
+                    mp->bad_captures[mp->bad_count++] = m;
+                    continue;
+                }
+                return m;
+            }
+            mp->stage = mp->tactical_only ? PICK_BAD_CAPTURES : PICK_KILLER_1;
+            mp->index = 0;
+            break;
+        case PICK_KILLER_1:
+            mp->stage = PICK_KILLER_2;
+            if (killer_usable(mp, mp->killers[0])) return mp->killers[0];
+            break;
+        case PICK_KILLER_2:
+            mp->stage = PICK_GEN_QUIETS;
+            if (mp->killers[1] != mp->killers[0] && killer_usable(mp, mp->killers[1])) return mp->killers[1];
+            break;
+        case PICK_GEN_QUIETS:
+            generate_quiet_list(mp->pos, &mp->list);
+            for (int i = 0; i < mp->list.count; ++i) {
+                Move m = mp->list.moves[i];
+                mp->scores[i] = mp->history ? mp->history[move_from(m) * 64 + move_to(m)] : 0;
+            }
+            mp->index = 0;
+            mp->stage = PICK_QUIETS;
+            break;
+        case PICK_QUIETS:
+            while (mp->index < mp->list.count) {
+                Move m = pick_best(mp);
+                if (m == mp->hash_move || m == mp->killers[0] || m == mp->killers[1]) continue;
+                return m;
+            }
+            mp->stage = PICK_BAD_CAPTURES;
+            mp->index = 0;
+            break;
+        case PICK_BAD_CAPTURES:
+            if (mp->index < mp->bad_count) return mp->bad_captures[mp->index++];
+            mp->stage = PICK_DONE;
+            break;
+        default:
+            return MOVE_NONE;
+        }
+    }
+}
@@ -0,0 +1,287 @@
+#include "nnue.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Build with -DNNUE_NO_SIMD to force the scalar loops. */
+#if defined(NNUE_NO_SIMD)
+#define NNUE_BACKEND "scalar"
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#define NNUE_AVX2
+#define NNUE_BACKEND "avx2"
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define NNUE_SSE2
+#define NNUE_BACKEND "sse2"
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define NNUE_NEON
+#define NNUE_BACKEND "neon"
+#else
+#define NNUE_BACKEND "scalar"
+#endif
+
+const NNUENet *nnue_net;
+static NNUENet *nnue_owned;
+
+const char *nnue_simd_backend(void) { return NNUE_BACKEND; }
+
+/* acc += add - sub over one NNUE_HIDDEN row; either source may be NULL. */
+static inline void row_update(int16_t *acc, const int16_t *add, const int16_t *sub)
+{
+#if defined(NNUE_AVX2)
+    for (int i = 0; i < NNUE_HIDDEN; i += 16) {
+        __m256i v = _mm256_load_si256((const __m256i *)(acc + i));
+        if (add) v = _mm256_add_epi16(v, _mm256_load_si256((const __m256i *)(add + i)));
+        if (sub) v = _mm256_sub_epi16(v, _mm256_load_si256((const __m256i *)(sub + i)));
+        _mm256_store_si256((__m256i *)(acc + i), v);
+    }
+#elif defined(NNUE_SSE2)
+    for (int i = 0; i < NNUE_HIDDEN; i += 8) {
+        __m128i v = _mm_load_si128((const __m128i *)(acc + i));
+        if (add) v = _mm_add_epi16(v, _mm_load_si128((const __m128i *)(add + i)));
+        if (sub) v = _mm_sub_epi16(v, _mm_load_si128((const __m128i *)(sub + i)));
+        _mm_store_si128((__m128i *)(acc + i), v);
+    }
+#elif defined(NNUE_NEON)
+    for (int i = 0; i < NNUE_HIDDEN; i += 8) {
+        int16x8_t v = vld1q_s16(acc + i);
+        if (add) v = vaddq_s16(v, vld1q_s16(add + i));
+        if (sub) v = vsubq_s16(v, vld1q_s16(sub + i));
+        vst1q_s16(acc + i, v);
+    }
+#else
+    for (int i = 0; i < NNUE_HIDDEN; ++i) acc[i] = (int16_t)(acc[i] + (add ? add[i] : 0) - (sub ? sub[i] : 0));
+#endif
+}
+
+/* sum(clamp(acc[i], 0, NNUE_QA) * w[i]) */
+static inline int32_t crelu_dot(const int16_t *acc, const int16_t *w)
+{
+#if defined(NNUE_AVX2)
+    const __m256i zero = _mm256_setzero_si256(), qa = _mm256_set1_epi16(NNUE_QA);
+    __m256i sum = _mm256_setzero_si256();
+    for (int i = 0; i < NNUE_HIDDEN; i += 16) {
+        __m256i a = _mm256_load_si256((const __m256i *)(acc + i));
+        a = _mm256_min_epi16(_mm256_max_epi16(a, zero), qa);
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(a, _mm256_load_si256((const __m256i *)(w + i))));
+    }
+    __m128i s = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+    s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(s);
+#elif defined(NNUE_SSE2)
+    const __m128i zero = _mm_setzero_si128(), qa = _mm_set1_epi16(NNUE_QA);
+    __m128i sum = _mm_setzero_si128();
+    for (int i = 0; i < NNUE_HIDDEN; i += 8) {
+        __m128i a = _mm_load_si128((const __m128i *)(acc + i));
+        a = _mm_min_epi16(_mm_max_epi16(a, zero), qa);
+        sum = _mm_add_epi32(sum, _mm_madd_epi16(a, _mm_load_si128((const __m128i *)(w + i))));
+    }
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(sum);
+#elif defined(NNUE_NEON)
+    const int16x8_t zero = vdupq_n_s16(0), qa = vdupq_n_s16(NNUE_QA);
+    int32x4_t sum = vdupq_n_s32(0);
+    for (int i = 0; i < NNUE_HIDDEN; i += 8) {
+        int16x8_t a = vminq_s16(vmaxq_s16(vld1q_s16(acc + i), zero), qa);
+        int16x8_t b = vld1q_s16(w + i);
+        sum = vmlal_s16(sum, vget_low_s16(a), vget_low_s16(b));
+        sum = vmlal_high_s16(sum, a, b);
+    }
+    return vaddvq_s32(sum);
+#else
+    int32_t sum = 0;
+    for (int i = 0; i < NNUE_HIDDEN; ++i) {
+        int a = acc[i] < 0 ? 0 : (acc[i] > NNUE_QA ? NNUE_QA : acc[i]);
+        sum += a * w[i];
+    }
+    return sum;
+#endif
+}
+
+static void acc_add(NNUEAccumulator *acc, int sq, int8_t v)
+{
+    const NNUENet *net = nnue_net;
+    row_update(acc->values[COLOR_WHITE], net->feature_weights[nnue_feature(COLOR_WHITE, v, sq)], NULL);
+    row_update(acc->values[COLOR_BLACK], net->feature_weights[nnue_feature(COLOR_BLACK, v, sq)], NULL);
+}
+
+void nnue_add_piece(Position *pos, int sq, int8_t v)
+{
+    acc_add(pos->nnue, sq, v);
+}
+
+void nnue_remove_piece(Position *pos, int sq, int8_t v)
+{
+    const NNUENet *net = nnue_net;
+    row_update(pos->nnue->values[COLOR_WHITE], NULL, net->feature_weights[nnue_feature(COLOR_WHITE, v, sq)]);
+    row_update(pos->nnue->values[COLOR_BLACK], NULL, net->feature_weights[nnue_feature(COLOR_BLACK, v, sq)]);
+}
+
+void nnue_move_piece(Position *pos, int from, int to, int8_t v)
+{
+    const NNUENet *net = nnue_net;
+    for (int p = COLOR_WHITE; p <= COLOR_BLACK; ++p) {
+        row_update(pos->nnue->values[p], net->feature_weights[nnue_feature(p, v, to)],
+                   net->feature_weights[nnue_feature(p, v, from)]);
+    }
+}
+
+void nnue_accumulate(const Position *pos, NNUEAccumulator *acc)
+{
+    memcpy(acc->values[COLOR_WHITE], nnue_net->feature_bias, sizeof nnue_net->feature_bias);
+    memcpy(acc->values[COLOR_BLACK], nnue_net->feature_bias, sizeof nnue_net->feature_bias);
+    for (int sq = 0; sq < 64; ++sq) {
+        int8_t v = pos->board[sq];
+        if (v != PIECE_EMPTY && piece_abs(v) <= PIECE_KING) acc_add(acc, sq, v);
+    }
+}
+
+void nnue_refresh(Position *pos)
+{
+    if (pos->nnue) nnue_accumulate(pos, pos->nnue);
+}
+
+void nnue_attach(Position *pos, NNUEAccumulator *stack)
+{
+    pos->nnue = nnue_net ? stack : NULL;
+    nnue_refresh(pos);
+}
+
+int nnue_evaluate(const Position *pos)
+{
+    const NNUENet *net = nnue_net;
+    NNUEAccumulator scratch;
+    const NNUEAccumulator *acc = pos->nnue;
+    if (!acc) {
+        nnue_accumulate(pos, &scratch);
+        acc = &scratch;
+    }
+    int us = pos->side_to_move, them = us ^ 1;
+    int64_t sum = (int64_t)net->output_bias + crelu_dot(acc->values[us], net->output_weights[0]) +
+                  crelu_dot(acc->values[them], net->output_weights[1]);
+    int64_t score = sum * NNUE_SCALE / (NNUE_QA * NNUE_QB);
+    if (score > 20000) score = 20000;
+    if (score < -20000) score = -20000;
+    return (int)score;
+}
+
+#define NNUE_FILE_SIZE (16 + 2 * ((size_t)NNUE_INPUTS * NNUE_HIDDEN + NNUE_HIDDEN + 2 * NNUE_HIDDEN) + 4)
+
+static uint32_t get_u32(const unsigned char *p)
+{
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+static void put_u32(unsigned char *p, uint32_t v)
+{
+    for (int i = 0; i < 4; ++i) p[i] = (unsigned char)(v >> (8 * i));
+}
+
+static const unsigned char *get_i16s(const unsigned char *p, int16_t *out, size_t n)
+{
+    for (size_t i = 0; i < n; ++i, p += 2) out[i] = (int16_t)(uint16_t)(p[0] | p[1] << 8);
+    return p;
+}
+
+static unsigned char *put_i16s(unsigned char *p, const int16_t *in, size_t n)
+{
+    for (size_t i = 0; i < n; ++i, p += 2) {
+        p[0] = (unsigned char)((uint16_t)in[i] & 0xFF);
+        p[1] = (unsigned char)((uint16_t)in[i] >> 8);
+    }
+    return p;
+}
+
+pos_error_t nnue_load(const char *path, char *errbuf, size_t errbuf_size)
+{
+    if (path == NULL) {
+        if (errbuf && errbuf_size) snprintf(errbuf, errbuf_size, "null path");
+        return POS_ERR_INVALID_ARG;
+    }
+    FILE *in = fopen(path, "rb");
+    if (!in) {
+        if (errbuf && errbuf_size) snprintf(errbuf, errbuf_size, "cannot open %s", path);
+        return POS_ERR_OTHER;
+    }
+    unsigned char *buf = malloc(NNUE_FILE_SIZE + 1);
+    size_t got = buf ? fread(buf, 1, NNUE_FILE_SIZE + 1, in) : 0;
+    fclose(in);
+    if (!buf) {
+        if (errbuf && errbuf_size) snprintf(errbuf, errbuf_size, "out of memory");
+        return POS_ERR_OTHER;
+    }
+    if (got < 16 || memcmp(buf, "NNUE", 4) != 0 || get_u32(buf + 4) != NNUE_FILE_VERSION) {
+        if (errbuf && errbuf_size) snprintf(errbuf, errbuf_size, "%s: not an NNUE version %d file", path, NNUE_FILE_VERSION);
+        free(buf);
+        return POS_ERR_OTHER;
+    }
+    if (get_u32(buf + 8) != NNUE_INPUTS || get_u32(buf + 12) != NNUE_HIDDEN || got != NNUE_FILE_SIZE) {
+        if (errbuf && errbuf_size)
+            snprintf(errbuf, errbuf_size, "%s: network is %ux%u (%zu bytes), expected %dx%d (%zu bytes)", path,
+                     get_u32(buf + 8), get_u32(buf + 12), got, NNUE_INPUTS, NNUE_HIDDEN, (size_t)NNUE_FILE_SIZE);
+        free(buf);
+        return POS_ERR_OTHER;
+    }
+
+    size_t net_size = (sizeof(NNUENet) + 63) & ~(size_t)63;
+    NNUENet *net = aligned_alloc(64, net_size);
+    if (!net) {
+        if (errbuf && errbuf_size) snprintf(errbuf, errbuf_size, "out of memory");
+        free(buf);
+        return POS_ERR_OTHER;
+    }
+    const unsigned char *p = buf + 16;
+    p = get_i16s(p, &net->feature_weights[0][0], (size_t)NNUE_INPUTS * NNUE_HIDDEN);
+    p = get_i16s(p, net->feature_bias, NNUE_HIDDEN);
+    p = get_i16s(p, &net->output_weights[0][0], 2 * NNUE_HIDDEN);
+    net->output_bias = (int32_t)get_u32(p);
+    free(buf);
+
+    nnue_unload();
+    nnue_owned = net;
+    nnue_net = net;
+    return POS_OK;
+}
+
+void nnue_unload(void)
+{
+    nnue_net = NULL;
+    free(nnue_owned);
+    nnue_owned = NULL;
+}
+
+pos_error_t nnue_save(const NNUENet *net, const char *path, char *errbuf, size_t errbuf_size)
+{
+    if (net == NULL || path == NULL) {
+        if (errbuf && errbuf_size) snprintf(errbuf, errbuf_size, "null argument");
+        return POS_ERR_INVALID_ARG;
+    }
+    unsigned char *buf = malloc(NNUE_FILE_SIZE);
+    if (!buf) {
+        if (errbuf && errbuf_size) snprintf(errbuf, errbuf_size, "out of memory");
+        return POS_ERR_OTHER;
+    }
+    memcpy(buf, "NNUE", 4);
+    put_u32(buf + 4, NNUE_FILE_VERSION);
+    put_u32(buf + 8, NNUE_INPUTS);
+    put_u32(buf + 12, NNUE_HIDDEN);
+    unsigned char *p = buf + 16;
+    p = put_i16s(p, &net->feature_weights[0][0], (size_t)NNUE_INPUTS * NNUE_HIDDEN);
+    p = put_i16s(p, net->feature_bias, NNUE_HIDDEN);
+    p = put_i16s(p, &net->output_weights[0][0], 2 * NNUE_HIDDEN);
+    put_u32(p, (uint32_t)net->output_bias);
+
+    FILE *out = fopen(path, "wb");
+    int ok = out && fwrite(buf, 1, NNUE_FILE_SIZE, out) == NNUE_FILE_SIZE;
+    if (out && fclose(out) != 0) ok = 0;
+    free(buf);
+    if (!ok) {
+        if (errbuf && errbuf_size) snprintf(errbuf, errbuf_size, "cannot write %s", path);
+        return POS_ERR_OTHER;
+    }
+    return POS_OK;
+}
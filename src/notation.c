@@ -0,0 +1,173 @@
+#include "movegen.h"
+#include <string.h>
+
+static const char piece_letters[] = " PNBRQK";
+
+int move_to_uci(Move m, char *buf)
+{
+    if (m == MOVE_NONE) {
+        memcpy(buf, "0000", 5);
+        return 4;
+    }
+    int from = move_from(m), to = move_to(m), n = 4;
+    buf[0] = (char)('a' + SQ_FILE(from));
+    buf[1] = (char)('1' + SQ_RANK(from));
+    buf[2] = (char)('a' + SQ_FILE(to));
+    buf[3] = (char)('1' + SQ_RANK(to));
+    if (move_promotion(m)) buf[n++] = (char)(piece_letters[move_promotion(m)] - 'A' + 'a');
+    buf[n] = '\0';
+    return n;
+}
+
+Move move_from_uci(const Position *pos, const char *text, size_t len)
+{
+    if (len != 4 && len != 5) return MOVE_NONE;
+    int from = position_square_from_coords(text[0], text[1]);
+    int to = position_square_from_coords(text[2], text[3]);
+    if (from == POS_NO_SQUARE || to == POS_NO_SQUARE) return MOVE_NONE;
+    int promotion = 0;
+    if (len == 5) {
+        switch (text[4]) {
+        case 'n': promotion = PIECE_KNIGHT; break;
+        case 'b': promotion = PIECE_BISHOP; break;
+        case 'r': promotion = PIECE_ROOK; break;
+        case 'q': promotion = PIECE_QUEEN; break;
+        default: return MOVE_NONE;
+        }
+    }
+    Move m = move_from_squares(pos, from, to, promotion);
+    return move_is_legal(pos, m) ? m : MOVE_NONE;
+}
+
+int move_to_san(const Position *pos, Move m, char *buf)
+{
+    MoveList list;
+    generate_legal_list(pos, &list);
+    int from = move_from(m), to = move_to(m);
+    int piece = piece_abs(pos->board[from]);
+    int legal = 0, same_file = 0, same_rank = 0, rivals = 0;
+    for (int i = 0; i < list.count; ++i) {
+        Move other = list.moves[i];
+        if (other == m) {
+            legal = 1;
+            continue;
+        }
+        int of = move_from(other);
+        if (move_to(other) != to || of == from || piece_abs(pos->board[of]) != piece) continue;
+        rivals++;
+        same_file += SQ_FILE(of) == SQ_FILE(from);
+        same_rank += SQ_RANK(of) == SQ_RANK(from);
+    }
+    if (!legal || m == MOVE_NONE) {
+        buf[0] = '\0';
+        return 0;
+    }
+
+    char *p = buf;
+    if (move_flag(m) == MOVE_FLAG_CASTLING) {
+        int queenside = SQ_FILE(to) < SQ_FILE(from);
+        memcpy(p, queenside ? "O-O-O" : "O-O", queenside ? 5 : 3);
+        p += queenside ? 5 : 3;
+    } else {
+        int capture = pos->board[to] != PIECE_EMPTY || move_flag(m) == MOVE_FLAG_EN_PASSANT;
+        if (piece == PIECE_PAWN) {
+            if (capture) *p++ = (char)('a' + SQ_FILE(from));
+        } else {
+            *p++ = piece_letters[piece];
+            /* file if it tells the rivals apart, else rank, else both */
+            if (rivals && (!same_file || same_rank)) *p++ = (char)('a' + SQ_FILE(from));
+            if (rivals && same_file) *p++ = (char)('1' + SQ_RANK(from));
+        }
+        if (capture) *p++ = 'x';
+        *p++ = (char)('a' + SQ_FILE(to));
+        *p++ = (char)('1' + SQ_RANK(to));
+        if (move_promotion(m)) {
+            *p++ = '=';
+            *p++ = piece_letters[move_promotion(m)];
+        }
+    }
+
+    Position after = *pos;
+    MoveUndo undo;
+    make_move_packed(&after, m, &undo);
+    if (position_in_check(&after)) *p++ = count_legal_moves(&after) ? '+' : '#';
+    *p = '\0';
+    return (int)(p - buf);
+}
+
+static int san_piece(char c)
+{
+    switch (c) {
+    case 'N': return PIECE_KNIGHT;
+    case 'B': return PIECE_BISHOP;
+    case 'R': return PIECE_ROOK;
+    case 'Q': return PIECE_QUEEN;
+    case 'K': return PIECE_KING;
+    default: return 0;
+    }
+}
+
+static Move san_castling(const Position *pos, const char *san, size_t len)
+{
+    int queenside;
+    if (len == 3 && (memcmp(san, "O-O", 3) == 0 || memcmp(san, "0-0", 3) == 0)) queenside = 0;
+    else if (len == 5 && (memcmp(san, "O-O-O", 5) == 0 || memcmp(san, "0-0-0", 5) == 0)) queenside = 1;
+    else return MOVE_NONE;
+
+    MoveList list;
+    generate_legal_list(pos, &list);
+    for (int i = 0; i < list.count; ++i) {
+        Move m = list.moves[i];
+        if (move_flag(m) == MOVE_FLAG_CASTLING && (SQ_FILE(move_to(m)) < SQ_FILE(move_from(m))) == queenside) return m;
+    }
+    return MOVE_NONE;
+}
+
+Move move_from_san(const Position *pos, const char *san, size_t len)
+{
+    while (len && (san[len - 1] == '+' || san[len - 1] == '#' || san[len - 1] == '!' || san[len - 1] == '?')) len--;
+    if (len < 2) return MOVE_NONE;
+    if (san[0] == 'O' || san[0] == '0') return san_castling(pos, san, len);
+
+    size_t i = 0;
+    int piece = san_piece(san[0]);
+    if (piece) i = 1;
+    else piece = PIECE_PAWN;
+
+    int promotion = 0;
+    if (piece == PIECE_PAWN) {
+        char c = san[len - 1];
+        int p = san_piece(c >= 'a' && c <= 'z' && len >= 2 && san[len - 2] == '=' ? (char)(c - 'a' + 'A') : c);
+        if (p && p != PIECE_KING) {
+            promotion = p;
+            len -= san[len - 2] == '=' ? 2 : 1;
+        }
+    }
+    if (len < i + 2) return MOVE_NONE;
+    int to = position_square_from_coords(san[len - 2], san[len - 1]);
+    if (to == POS_NO_SQUARE) return MOVE_NONE;
+
+    int from_file = -1, from_rank = -1;
+    for (len -= 2; i < len; ++i) {
+        char c = san[i];
+        if (c >= 'a' && c <= 'h') from_file = c - 'a';
+        else if (c >= '1' && c <= '8') from_rank = c - '1';
+        else if (c != 'x' && c != ':' && c != '-') return MOVE_NONE;
+    }
+    /* "e4" never names a capture onto e4 */
+    if (piece == PIECE_PAWN && from_file < 0) from_file = SQ_FILE(to);
+
+    MoveList list;
+    generate_legal_list(pos, &list);
+    Move found = MOVE_NONE;
+    for (int k = 0; k < list.count; ++k) {
+        Move m = list.moves[k];
+        int from = move_from(m);
+        if (move_to(m) != to || piece_abs(pos->board[from]) != piece || move_promotion(m) != promotion) continue;
+        if (move_flag(m) == MOVE_FLAG_CASTLING) continue;
+        if ((from_file >= 0 && SQ_FILE(from) != from_file) || (from_rank >= 0 && SQ_RANK(from) != from_rank)) continue;
+        if (found != MOVE_NONE) return MOVE_NONE;
+        found = m;
+    }
+    return found;
+}
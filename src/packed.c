@@ -0,0 +1,167 @@
+#define _POSIX_C_SOURCE 200809L
+#include "packed.h"
+#include "bitboard.h"
+#include "zobrist.h"
+#include "mapfile.h"
+#include <stdio.h>
+#include <string.h>
+
+#define PACKED_NO_EP 0xFF
+
+static void put_le(uint8_t *p, uint64_t v, int bytes)
+{
+    for (int i = 0; i < bytes; ++i) p[i] = (uint8_t)(v >> (8 * i));
+}
+
+static uint64_t get_le(const uint8_t *p, int bytes)
+{
+    uint64_t v = 0;
+    for (int i = 0; i < bytes; ++i) v |= (uint64_t)p[i] << (8 * i);
+    return v;
+}
+
+pos_error_t position_pack(const Position *pos, PackedPosition *out)
+{
+    if (pos == NULL || out == NULL) return POS_ERR_INVALID_ARG;
+    Bitboard occ = position_occupied(pos);
+    if (bb_popcount(occ) > PACKED_MAX_PIECES) return POS_ERR_INVALID_ARG;
+
+    memset(out->bytes, 0, sizeof out->bytes);
+    put_le(out->bytes, occ, 8);
+    uint8_t *nibbles = out->bytes + 8;
+    for (int i = 0; occ; ++i) {
+        int8_t v = pos->board[bb_pop_lsb(&occ)];
+        uint8_t code = (uint8_t)(piece_abs(v) | (v < 0 ? 8 : 0));
+        nibbles[i >> 1] |= (uint8_t)(code << (4 * (i & 1)));
+    }
+    out->bytes[24] = (uint8_t)((pos->side_to_move & 1) | (pos->castling & 15) << 1);
+    out->bytes[25] = pos->en_passant == POS_NO_SQUARE ? PACKED_NO_EP : (uint8_t)pos->en_passant;
+    put_le(out->bytes + 26, pos->halfmove_clock, 2);
+    put_le(out->bytes + 28, pos->fullmove_number, 4);
+    return POS_OK;
+}
+
+pos_error_t position_unpack(Position *pos, const PackedPosition *in, unsigned flags,
+                            char *errbuf, size_t errbuf_size)
+{
+    if (pos == NULL || in == NULL) {
+        if (errbuf && errbuf_size) snprintf(errbuf, errbuf_size, "null argument");
+        return POS_ERR_INVALID_ARG;
+    }
+    position_init(pos);
+
+    Bitboard occ = get_le(in->bytes, 8);
+    if (bb_popcount(occ) > PACKED_MAX_PIECES) {
+        if (errbuf && errbuf_size) snprintf(errbuf, errbuf_size, "bad packed position: %d pieces", bb_popcount(occ));
+        return POS_ERR_INVARIANT;
+    }
+    const uint8_t *nibbles = in->bytes + 8;
+    for (int i = 0; occ; ++i) {
+        int sq = bb_pop_lsb(&occ);
+        int code = (nibbles[i >> 1] >> (4 * (i & 1))) & 15;
+        int type = code & 7;
+        if (type < PIECE_PAWN || type > PIECE_KING) {
+            if (errbuf && errbuf_size) snprintf(errbuf, errbuf_size, "bad packed position: piece code %d on sq %d", code, sq);
+            return POS_ERR_INVARIANT;
+        }
+        pos->board[sq] = (int8_t)(code & 8 ? -type : type);
+    }
+
+    uint8_t state = in->bytes[24], ep = in->bytes[25];
+    if (state >> 5 || (ep != PACKED_NO_EP && ep >= 64)) {
+        if (errbuf && errbuf_size) snprintf(errbuf, errbuf_size, "bad packed position: state %#x, en-passant %d", state, ep);
+        return POS_ERR_INVARIANT;
+    }
+    pos->side_to_move = state & 1;
+    pos->castling = (uint8_t)(state >> 1);
+    pos->en_passant = ep == PACKED_NO_EP ? POS_NO_SQUARE : (int8_t)ep;
+    pos->halfmove_clock = (uint16_t)get_le(in->bytes + 26, 2);
+    pos->fullmove_number = (uint32_t)get_le(in->bytes + 28, 4);
+
+    position_sync_bitboards(pos);
+    pos->hash = zobrist_compute(pos);
+    pos->pawn_key = zobrist_compute_pawns(pos);
+    if (flags & FEN_NO_VALIDATE) return POS_OK;
+    return position_validate(pos, errbuf, errbuf_size);
+}
+
+pos_error_t packed_file_write(const char *path, const Position *positions, size_t count,
+                              char *errbuf, size_t errbuf_size)
+{
+    if (path == NULL || (positions == NULL && count > 0)) {
+        if (errbuf && errbuf_size) snprintf(errbuf, errbuf_size, "null argument");
+        return POS_ERR_INVALID_ARG;
+    }
+    FILE *out = fopen(path, "wb");
+    if (!out) {
+        if (errbuf && errbuf_size) snprintf(errbuf, errbuf_size, "cannot open %s", path);
+        return POS_ERR_OTHER;
+    }
+    uint8_t header[PACKED_FILE_HEADER_SIZE];
+    memcpy(header, PACKED_FILE_MAGIC, 4);
+    put_le(header + 4, PACKED_FILE_VERSION, 2);
+    put_le(header + 6, PACKED_POSITION_SIZE, 2);
+    put_le(header + 8, count, 8);
+    int ok = fwrite(header, sizeof header, 1, out) == 1;
+    pos_error_t r = POS_OK;
+    for (size_t i = 0; ok && i < count; ++i) {
+        PackedPosition rec;
+        r = position_pack(&positions[i], &rec);
+        if (r != POS_OK) {
+            if (errbuf && errbuf_size) snprintf(errbuf, errbuf_size, "position %zu has more than %d pieces", i, PACKED_MAX_PIECES);
+            break;
+        }
+        ok = fwrite(rec.bytes, sizeof rec.bytes, 1, out) == 1;
+    }
+    if (fclose(out) != 0) ok = 0;
+    if (r == POS_OK && !ok) {
+        if (errbuf && errbuf_size) snprintf(errbuf, errbuf_size, "cannot write %s", path);
+        r = POS_ERR_OTHER;
+    }
+    if (r != POS_OK) remove(path);
+    return r;
+}
+
+pos_error_t packed_file_open(PackedFile *f, const char *path, char *errbuf, size_t errbuf_size)
+{
+    if (f == NULL || path == NULL) {
+        if (errbuf && errbuf_size) snprintf(errbuf, errbuf_size, "null argument");
+        return POS_ERR_INVALID_ARG;
+    }
+    memset(f, 0, sizeof *f);
+
+    const void *map;
+    size_t size;
+    pos_error_t err = map_file(path, &map, &size, errbuf, errbuf_size);
+    if (err != POS_OK) return err;
+    if (size < PACKED_FILE_HEADER_SIZE) {
+        if (errbuf && errbuf_size) snprintf(errbuf, errbuf_size, "%s: missing header", path);
+        unmap_file(map, size);
+        return POS_ERR_OTHER;
+    }
+
+    const uint8_t *header = map;
+    uint64_t count = get_le(header + 8, 8);
+    const char *problem = NULL;
+    if (memcmp(header, PACKED_FILE_MAGIC, 4) != 0) problem = "not a packed position file";
+    else if (get_le(header + 4, 2) != PACKED_FILE_VERSION) problem = "unsupported version";
+    else if (get_le(header + 6, 2) != PACKED_POSITION_SIZE) problem = "unexpected record size";
+    else if (count > (size - PACKED_FILE_HEADER_SIZE) / PACKED_POSITION_SIZE) problem = "truncated";
+    if (problem) {
+        if (errbuf && errbuf_size) snprintf(errbuf, errbuf_size, "%s: %s", path, problem);
+        unmap_file(map, size);
+        return POS_ERR_OTHER;
+    }
+    f->records = (const PackedPosition *)(header + PACKED_FILE_HEADER_SIZE);
+    f->count = (size_t)count;
+    f->map = map;
+    f->map_size = size;
+    return POS_OK;
+}
+
+void packed_file_close(PackedFile *f)
+{
+    if (f == NULL) return;
+    unmap_file(f->map, f->map_size);
+    memset(f, 0, sizeof *f);
+}
@@ -0,0 +1,153 @@
+#include "pawns.h"
+#include "bitboard.h"
+#include <string.h>
+
+#define DOUBLED_MG  (-10)
+#define DOUBLED_EG  (-20)
+#define ISOLATED_MG (-10)
+#define ISOLATED_EG (-15)
+#define BACKWARD_MG (-8)
+#define BACKWARD_EG (-10)
+
+/* Indexed by relative rank. */
+static const int passed_mg[8] = { 0, 5, 10, 15, 25, 40, 60, 0 };
+static const int passed_eg[8] = { 0, 10, 20, 35, 60, 100, 150, 0 };
+
+/* Indexed by the distance from the king to the nearest own pawn on a shield
+ * file; 0 = no pawn in front of the king there, 3+ counts as missing. */
+static const int shield_mg[4] = { -25, 0, -10, -25 };
+
+static Bitboard adjacent_files[8];
+static Bitboard front_span[2][64];      /* same file, strictly ahead */
+static Bitboard passed_span[2][64];     /* same and adjacent files, strictly ahead */
+static Bitboard support_span[2][64];    /* adjacent files, same rank or behind */
+
+__attribute__((constructor))
+static void pawns_init(void)
+{
+    for (int f = 0; f < 8; ++f) {
+        adjacent_files[f] = (f > 0 ? BB_FILE_A << (f - 1) : 0) | (f < 7 ? BB_FILE_A << (f + 1) : 0);
+    }
+    for (int sq = 0; sq < 64; ++sq) {
+        int file = SQ_FILE(sq), rank = SQ_RANK(sq);
+        Bitboard file_bb = BB_FILE_A << file;
+        Bitboard above = rank < 7 ? ~0ULL << (8 * (rank + 1)) : 0;
+        Bitboard below = rank > 0 ? ~0ULL >> (8 * (8 - rank)) : 0;
+        Bitboard through = below | (BB_RANK_1 << (8 * rank));
+        Bitboard through_up = above | (BB_RANK_1 << (8 * rank));
+        front_span[COLOR_WHITE][sq] = file_bb & above;
+        front_span[COLOR_BLACK][sq] = file_bb & below;
+        passed_span[COLOR_WHITE][sq] = (file_bb | adjacent_files[file]) & above;
+        passed_span[COLOR_BLACK][sq] = (file_bb | adjacent_files[file]) & below;
+        support_span[COLOR_WHITE][sq] = adjacent_files[file] & through;
+        support_span[COLOR_BLACK][sq] = adjacent_files[file] & through_up;
+    }
+}
+
+static void pawn_structure(const Position *pos, int color, int *mg, int *eg)
+{
+    Bitboard ours = position_pieces(pos, color, PIECE_PAWN);
+    Bitboard theirs = position_pieces(pos, color ^ 1, PIECE_PAWN);
+    Bitboard b = ours;
+    while (b) {
+        int sq = bb_pop_lsb(&b);
+        int rank = color == COLOR_WHITE ? SQ_RANK(sq) : 7 - SQ_RANK(sq);
+        int blocked_by_own = (front_span[color][sq] & ours) != 0;
+        if (blocked_by_own) {
+            *mg += DOUBLED_MG;
+            *eg += DOUBLED_EG;
+        }
+        if (!(adjacent_files[SQ_FILE(sq)] & ours)) {
+            *mg += ISOLATED_MG;
+            *eg += ISOLATED_EG;
+        } else if (rank < 7 && !(support_span[color][sq] & ours) &&
+                   (bb_pawn_attacks[color][color == COLOR_WHITE ? sq + 8 : sq - 8] & theirs)) {
+            *mg += BACKWARD_MG;
+            *eg += BACKWARD_EG;
+        }
+        if (!blocked_by_own && !(passed_span[color][sq] & theirs)) {
+            *mg += passed_mg[rank];
+            *eg += passed_eg[rank];
+        }
+    }
+}
+
+static int king_shield(const Position *pos, int color, int king_sq)
+{
+    if (king_sq == POS_NO_SQUARE) return 0;
+    Bitboard ours = position_pieces(pos, color, PIECE_PAWN);
+    int king_file = SQ_FILE(king_sq), king_rank = SQ_RANK(king_sq);
+    int score = 0;
+    for (int f = king_file > 0 ? king_file - 1 : 0; f <= (king_file < 7 ? king_file + 1 : 7); ++f) {
+        Bitboard in_front = ours & front_span[color][SQ_INDEX(f, king_rank)];
+        int distance = 0;
+        if (in_front) {
+            int nearest = color == COLOR_WHITE ? bb_lsb(in_front) : bb_msb(in_front);
+            distance = SQ_RANK(nearest) - king_rank;
+            if (distance < 0) distance = -distance;
+            if (distance > 3) distance = 3;
+        }
+        score += shield_mg[distance];
+    }
+    return score;
+}
+
+static void structure_terms(const Position *pos, int *mg, int *eg)
+{
+    int w_mg = 0, w_eg = 0, b_mg = 0, b_eg = 0;
+    pawn_structure(pos, COLOR_WHITE, &w_mg, &w_eg);
+    pawn_structure(pos, COLOR_BLACK, &b_mg, &b_eg);
+    *mg = w_mg - b_mg;
+    *eg = w_eg - b_eg;
+}
+
+void pawn_table_clear(PawnTable *pt)
+{
+    /* A zero key with zero terms is the correct entry for a pawnless position,
+     * so cleared slots never need a separate empty marker. */
+    memset(pt->entries, 0, sizeof pt->entries);
+    for (int i = 0; i < PAWN_TABLE_ENTRIES; ++i) {
+        pt->entries[i].king_sq[COLOR_WHITE] = POS_NO_SQUARE;
+        pt->entries[i].king_sq[COLOR_BLACK] = POS_NO_SQUARE;
+    }
+    pt->probes = 0;
+    pt->hits = 0;
+}
+
+void pawn_evaluate(const Position *pos, PawnTable *pt, int *mg, int *eg)
+{
+    int king_sq[2];
+    for (int c = COLOR_WHITE; c <= COLOR_BLACK; ++c) {
+        Bitboard king = position_pieces(pos, c, PIECE_KING);
+        king_sq[c] = king ? bb_lsb(king) : POS_NO_SQUARE;
+    }
+    if (!pt) {
+        int s_mg, s_eg;
+        structure_terms(pos, &s_mg, &s_eg);
+        *mg += s_mg + king_shield(pos, COLOR_WHITE, king_sq[COLOR_WHITE]) -
+               king_shield(pos, COLOR_BLACK, king_sq[COLOR_BLACK]);
+        *eg += s_eg;
+        return;
+    }
+
+    PawnEntry *e = &pt->entries[pos->pawn_key & (PAWN_TABLE_ENTRIES - 1)];
+    pt->probes++;
+    if (e->key == pos->pawn_key) {
+        pt->hits++;
+    } else {
+        int s_mg, s_eg;
+        structure_terms(pos, &s_mg, &s_eg);
+        e->key = pos->pawn_key;
+        e->mg = (int16_t)s_mg;
+        e->eg = (int16_t)s_eg;
+        e->king_sq[COLOR_WHITE] = e->king_sq[COLOR_BLACK] = POS_NO_SQUARE;
+    }
+    for (int c = COLOR_WHITE; c <= COLOR_BLACK; ++c) {
+        if (e->king_sq[c] != king_sq[c]) {
+            e->shield[c] = (int16_t)king_shield(pos, c, king_sq[c]);
+            e->king_sq[c] = (int8_t)king_sq[c];
+        }
+    }
+    *mg += e->mg + e->shield[COLOR_WHITE] - e->shield[COLOR_BLACK];
+    *eg += e->eg;
+}
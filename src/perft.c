@@ -0,0 +1,240 @@
+#include "perft.h"
+#include "movegen.h"
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define PERFT_TASKS_PER_THREAD 64
+#define PERFT_MIN_TASK_DEPTH   2
+
+typedef struct {
+    Position pos;
+    int depth;
+    uint64_t nodes;
+} PerftTask;
+
+typedef struct {
+    PerftTask *tasks;
+    size_t count;
+    atomic_size_t next;
+    PerftTable *table;
+} PerftJob;
+
+/* Lockless entry: check holds key ^ data, so a torn write from another thread
+ * fails verification instead of returning a wrong count. data = nodes << 8 | depth. */
+typedef struct {
+    _Atomic uint64_t check;
+    _Atomic uint64_t data;
+} PerftEntry;
+
+struct PerftTable {
+    PerftEntry *entries;
+    size_t mask;
+};
+
+int perft_default_threads(void)
+{
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+}
+
+static PerftTask *split_tasks(const Position *root, int depth, size_t target, size_t *count_out)
+{
+    size_t count = 1;
+    PerftTask *tasks = malloc(sizeof *tasks);
+    if (!tasks) return NULL;
+    tasks[0].pos = *root;
+    tasks[0].depth = depth;
+    tasks[0].nodes = 0;
+
+    while (count < target) {
+        /* Split tasks only until the level reaches target, and count their
+         * moves first: a task holds a whole Position, so size it exactly. */
+        int *moves = malloc(sizeof *moves * count);
+        if (!moves) break;
+        size_t total = count, split = 0;
+        for (size_t i = 0; i < count; ++i) {
+            moves[i] = -1;
+            if (total < target && tasks[i].depth > PERFT_MIN_TASK_DEPTH) {
+                moves[i] = count_legal_moves(&tasks[i].pos);
+                total = total - 1 + (size_t)moves[i];
+                split++;
+            }
+        }
+        PerftTask *next = split && total ? malloc(sizeof *next * total) : NULL;
+        if (!next) {
+            free(moves);
+            break;
+        }
+        /* Tasks left whole are usually the larger ones; queue them first. */
+        size_t next_count = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (moves[i] < 0) next[next_count++] = tasks[i];
+        }
+        for (size_t i = 0; i < count; ++i) {
+            if (moves[i] < 0) continue;
+            MoveList list;
+            generate_legal_list(&tasks[i].pos, &list);
+            for (int m = 0; m < list.count; ++m) {
+                PerftTask *t = &next[next_count++];
+                MoveUndo undo;
+                t->pos = tasks[i].pos;
+                make_move_packed(&t->pos, list.moves[m], &undo);
+                t->depth = tasks[i].depth - 1;
+                t->nodes = 0;
+            }
+        }
+        free(moves);
+        free(tasks);
+        tasks = next;
+        count = next_count;
+    }
+    *count_out = count;
+    return tasks;
+}
+
+PerftTable *perft_table_create(size_t megabytes)
+{
+    size_t bytes = megabytes ? megabytes << 20 : 1u << 20;
+    size_t count = 1;
+    while (count * 2 * sizeof(PerftEntry) <= bytes) count *= 2;
+    PerftTable *table = malloc(sizeof *table);
+    if (!table) return NULL;
+    table->entries = malloc(count * sizeof(PerftEntry));
+    if (!table->entries) {
+        free(table);
+        return NULL;
+    }
+    table->mask = count - 1;
+    perft_table_clear(table);
+    return table;
+}
+
+void perft_table_destroy(PerftTable *table)
+{
+    if (!table) return;
+    free(table->entries);
+    free(table);
+}
+
+void perft_table_clear(PerftTable *table)
+{
+    if (!table) return;
+    for (size_t i = 0; i <= table->mask; ++i) {
+        atomic_init(&table->entries[i].check, 0);
+        atomic_init(&table->entries[i].data, 0);
+    }
+}
+
+static uint64_t perft_hashed_rec(Position *pos, int depth, PerftTable *table)
+{
+    if (depth <= 1) return perft(pos, depth);
+
+    uint64_t key = pos->hash;
+    PerftEntry *e = &table->entries[key & table->mask];
+    uint64_t data = atomic_load_explicit(&e->data, memory_order_relaxed);
+    uint64_t check = atomic_load_explicit(&e->check, memory_order_relaxed);
+    if ((check ^ data) == key && (int)(data & 0xFF) == depth) return data >> 8;
+
+    MoveList list;
+    generate_legal_list(pos, &list);
+    uint64_t nodes = 0;
+    MoveUndo undo;
+    for (int i = 0; i < list.count; ++i) {
+        make_move_packed(pos, list.moves[i], &undo);
+        nodes += perft_hashed_rec(pos, depth - 1, table);
+        unmake_move(pos, &undo);
+    }
+
+    data = (nodes << 8) | (uint64_t)depth;
+    atomic_store_explicit(&e->data, data, memory_order_relaxed);
+    atomic_store_explicit(&e->check, key ^ data, memory_order_relaxed);
+    return nodes;
+}
+
+static void *perft_worker(void *arg)
+{
+    PerftJob *job = arg;
+    for (;;) {
+        size_t i = atomic_fetch_add_explicit(&job->next, 1, memory_order_relaxed);
+        if (i >= job->count) break;
+        PerftTask *t = &job->tasks[i];
+        t->nodes = job->table ? perft_hashed_rec(&t->pos, t->depth, job->table)
+                              : perft(&t->pos, t->depth);
+    }
+    return NULL;
+}
+
+static uint64_t run_perft(const Position *pos, int depth, int threads, PerftTable *table)
+{
+    PerftJob job;
+    job.table = table;
+    job.tasks = NULL;
+    job.count = 0;
+    if (threads > 1 && depth > PERFT_MIN_TASK_DEPTH)
+        job.tasks = split_tasks(pos, depth, (size_t)threads * PERFT_TASKS_PER_THREAD, &job.count);
+    if (!job.tasks) {
+        Position copy = *pos;
+        return table ? perft_hashed_rec(&copy, depth, table) : perft(&copy, depth);
+    }
+    atomic_init(&job.next, 0);
+
+    pthread_t *workers = malloc(sizeof *workers * (size_t)threads);
+    int started = 0;
+    if (workers) {
+        for (; started < threads - 1; ++started) {
+            if (pthread_create(&workers[started], NULL, perft_worker, &job) != 0) break;
+        }
+    }
+    perft_worker(&job);
+    for (int i = 0; i < started; ++i) pthread_join(workers[i], NULL);
+    free(workers);
+
+    uint64_t nodes = 0;
+    for (size_t i = 0; i < job.count; ++i) nodes += job.tasks[i].nodes;
+    free(job.tasks);
+    return nodes;
+}
+
+uint64_t perft_parallel(const Position *pos, int depth, int threads)
+{
+    return run_perft(pos, depth, threads, NULL);
+}
+
+uint64_t perft_hashed(const Position *pos, int depth, int threads, PerftTable *table)
+{
+    return run_perft(pos, depth, threads, table);
+}
+
+static void perft_detailed_rec(Position *pos, int ply, int depth, PerftStats *stats)
+{
+    MoveList list;
+    generate_legal_list(pos, &list);
+    PerftStats *s = &stats[ply];
+    MoveUndo undo;
+    for (int i = 0; i < list.count; ++i) {
+        Move m = list.moves[i];
+        make_move_packed(pos, m, &undo);
+        s->nodes++;
+        if (undo.captured_piece != PIECE_EMPTY) s->captures++;
+        if (move_flag(m) == MOVE_FLAG_EN_PASSANT) s->en_passant++;
+        if (move_flag(m) == MOVE_FLAG_CASTLING) s->castles++;
+        if (move_flag(m) == MOVE_FLAG_PROMOTION) s->promotions++;
+        if (position_in_check(pos)) {
+            s->checks++;
+            if (count_legal_moves(pos) == 0) s->checkmates++;
+        }
+        if (ply + 1 < depth) perft_detailed_rec(pos, ply + 1, depth, stats);
+        unmake_move(pos, &undo);
+    }
+}
+
+void perft_detailed(const Position *pos, int depth, PerftStats *stats_by_ply)
+{
+    if (depth <= 0) return;
+    memset(stats_by_ply, 0, sizeof *stats_by_ply * (size_t)depth);
+    Position copy = *pos;
+    perft_detailed_rec(&copy, 0, depth, stats_by_ply);
+}
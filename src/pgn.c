@@ -0,0 +1,322 @@
+#define _POSIX_C_SOURCE 200809L
+#include "pgn.h"
+#include "mapfile.h"
+#include <stdio.h>
+#include <string.h>
+
+static const char start_fen[] = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+enum { TOKEN_END, TOKEN_MOVE };
+
+static inline int pgn_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+static inline int pgn_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+static inline int token_char(char c)
+{
+    return !pgn_space(c) && c != '{' && c != '}' && c != '(' && c != ')' && c != ';' && c != '[' && c != ']' &&
+           c != '$';
+}
+
+pos_error_t pgn_open(PgnReader *r, const char *path, unsigned flags, char *errbuf, size_t errbuf_size)
+{
+    if (r == NULL || path == NULL) {
+        if (errbuf && errbuf_size) snprintf(errbuf, errbuf_size, "null argument");
+        return POS_ERR_INVALID_ARG;
+    }
+    pgn_open_buffer(r, NULL, 0, flags);
+
+    const void *data;
+    size_t size;
+    pos_error_t err = map_file(path, &data, &size, errbuf, errbuf_size);
+    if (err != POS_OK) return err;
+    r->data = data;
+    r->size = size;
+    r->mapped = data != NULL;
+    return POS_OK;
+}
+
+void pgn_open_buffer(PgnReader *r, const char *data, size_t size, unsigned flags)
+{
+    if (r == NULL) return;
+    r->data = data;
+    r->size = data ? size : 0;
+    r->offset = 0;
+    r->line = 1;
+    r->flags = flags;
+    r->in_game = 0;
+    r->mapped = 0;
+}
+
+void pgn_close(PgnReader *r)
+{
+    if (r == NULL) return;
+    if (r->mapped) unmap_file(r->data, r->size);
+    pgn_open_buffer(r, NULL, 0, r->flags);
+}
+
+static void skip_space(PgnReader *r)
+{
+    while (r->offset < r->size && pgn_space(r->data[r->offset])) {
+        if (r->data[r->offset] == '\n') r->line++;
+        r->offset++;
+    }
+}
+
+static void skip_line(PgnReader *r)
+{
+    const char *nl = memchr(r->data + r->offset, '\n', r->size - r->offset);
+    if (nl) {
+        r->offset = (size_t)(nl - r->data) + 1;
+        r->line++;
+    } else {
+        r->offset = r->size;
+    }
+}
+
+static void skip_comment(PgnReader *r)
+{
+    for (r->offset++; r->offset < r->size && r->data[r->offset] != '}'; r->offset++) {
+        if (r->data[r->offset] == '\n') r->line++;
+    }
+    if (r->offset < r->size) r->offset++;
+}
+
+static void skip_variation(PgnReader *r)
+{
+    int depth = 0;
+    while (r->offset < r->size) {
+        char c = r->data[r->offset];
+        if (c == '{') {
+            skip_comment(r);
+            continue;
+        }
+        if (c == ';') {
+            skip_line(r);
+            continue;
+        }
+        if (c == '\n') r->line++;
+        r->offset++;
+        if (c == '(') depth++;
+        else if (c == ')' && --depth == 0) return;
+    }
+}
+
+static int at_line_start(const PgnReader *r)
+{
+    return r->offset == 0 || r->data[r->offset - 1] == '\n';
+}
+
+static int is_result(const char *s, size_t n)
+{
+    return (n == 1 && s[0] == '*') || (n == 3 && (memcmp(s, "1-0", 3) == 0 || memcmp(s, "0-1", 3) == 0)) ||
+           (n == 7 && memcmp(s, "1/2-1/2", 7) == 0);
+}
+
+/* Next main-line move, or TOKEN_END at a result, the next tag section or the
+ * end of input. Move numbers, NAGs, comments and variations are skipped. */
+static int next_token(PgnReader *r, PgnGame *g, const char **tok, size_t *len)
+{
+    for (;;) {
+        skip_space(r);
+        if (r->offset >= r->size) return TOKEN_END;
+        char c = r->data[r->offset];
+        if (c == '[') return TOKEN_END;
+        if (c == '{') {
+            skip_comment(r);
+            continue;
+        }
+        if (c == ';' || (c == '%' && at_line_start(r))) {
+            skip_line(r);
+            continue;
+        }
+        if (c == '(') {
+            skip_variation(r);
+            continue;
+        }
+        if (c == '$') {
+            for (r->offset++; r->offset < r->size && pgn_digit(r->data[r->offset]); r->offset++) {}
+            continue;
+        }
+        if (!token_char(c)) {
+            r->offset++;
+            continue;
+        }
+
+        const char *s = r->data + r->offset;
+        size_t n = 0;
+        while (r->offset + n < r->size && token_char(s[n])) n++;
+        r->offset += n;
+        if (is_result(s, n)) {
+            if (g) {
+                g->result = s;
+                g->result_len = n;
+            }
+            return TOKEN_END;
+        }
+
+        /* "12." and "12..." may be glued to the move that follows */
+        size_t k = 0;
+        while (k < n && pgn_digit(s[k])) k++;
+        if (k == n) continue;
+        if (s[k] == '.' || k == 0) {
+            while (k < n && s[k] == '.') k++;
+            s += k;
+            n -= k;
+        }
+        size_t marks = 0;
+        while (marks < n && (s[marks] == '!' || s[marks] == '?')) marks++;
+        if (marks == n || (n == 4 && memcmp(s, "e.p.", 4) == 0)) continue;
+        *tok = s;
+        *len = n;
+        return TOKEN_MOVE;
+    }
+}
+
+static void parse_tag(PgnReader *r, PgnGame *g)
+{
+    const char *p = r->data + r->offset + 1, *end = r->data + r->size;
+    while (p < end && (*p == ' ' || *p == '\t')) p++;
+    const char *name = p;
+    while (p < end && !pgn_space(*p) && *p != '"' && *p != ']') p++;
+    const char *name_end = p;
+    while (p < end && (*p == ' ' || *p == '\t')) p++;
+    if (p < end && *p == '"') {
+        const char *value = ++p;
+        while (p < end && *p != '"' && *p != '\n') {
+            if (*p == '\\' && p + 1 < end && p[1] != '\n') p++;
+            p++;
+        }
+        if (p < end && *p == '"' && g->tag_count < PGN_MAX_TAGS) {
+            PgnTag *t = &g->tags[g->tag_count++];
+            t->name = name;
+            t->name_len = (size_t)(name_end - name);
+            t->value = value;
+            t->value_len = (size_t)(p - value);
+        }
+    }
+    while (p < end && *p != ']' && *p != '\n') p++;
+    if (p < end && *p == ']') p++;
+    r->offset = (size_t)(p - r->data);
+}
+
+int pgn_next_game(PgnReader *r, PgnGame *g)
+{
+    if (r->in_game) {
+        const char *tok;
+        size_t len;
+        while (next_token(r, NULL, &tok, &len) == TOKEN_MOVE) {}
+        r->in_game = 0;
+    }
+    for (;;) {
+        skip_space(r);
+        if (r->offset >= r->size) return 0;
+        char c = r->data[r->offset];
+        if (c == ';' || (c == '%' && at_line_start(r))) skip_line(r);
+        else if (c == '{') skip_comment(r);
+        else break;
+    }
+
+    g->tag_count = 0;
+    g->plies = 0;
+    g->result = NULL;
+    g->result_len = 0;
+    g->line = r->line;
+    g->offset = r->offset;
+    g->status = POS_OK;
+    g->error[0] = '\0';
+    while (r->offset < r->size && r->data[r->offset] == '[') {
+        parse_tag(r, g);
+        skip_space(r);
+    }
+
+    size_t fen_len = 0;
+    const char *fen = pgn_tag(g, "FEN", &fen_len);
+    if (!fen) {
+        fen = start_fen;
+        fen_len = sizeof start_fen - 1;
+    }
+    char reason[128];
+    g->status = position_from_fen_n(&g->pos, fen, fen_len, r->flags, NULL, reason, sizeof reason);
+    if (g->status != POS_OK) snprintf(g->error, sizeof g->error, "line %zu: FEN tag: %s", g->line, reason);
+    r->in_game = 1;
+    return 1;
+}
+
+int pgn_next_move(PgnReader *r, PgnGame *g, Move *move)
+{
+    if (!r->in_game || g->status != POS_OK) return 0;
+    const char *tok;
+    size_t len;
+    if (next_token(r, g, &tok, &len) != TOKEN_MOVE) {
+        r->in_game = 0;
+        return 0;
+    }
+    Move m = move_from_san(&g->pos, tok, len);
+    if (m == MOVE_NONE) {
+        g->status = POS_ERR_OTHER;
+        snprintf(g->error, sizeof g->error, "line %zu: illegal or ambiguous move '%.*s' at ply %d", r->line,
+                 (int)(len < 16 ? len : 16), tok, g->plies + 1);
+        return 0;
+    }
+    MoveUndo undo;
+    make_move_packed(&g->pos, m, &undo);
+    g->plies++;
+    if (move) *move = m;
+    return 1;
+}
+
+const char *pgn_tag(const PgnGame *g, const char *name, size_t *len)
+{
+    size_t name_len = strlen(name);
+    for (int i = 0; i < g->tag_count; ++i) {
+        const PgnTag *t = &g->tags[i];
+        if (t->name_len == name_len && memcmp(t->name, name, name_len) == 0) {
+            if (len) *len = t->value_len;
+            return t->value;
+        }
+    }
+    return NULL;
+}
+
+/* Start of the first line at or after from that opens a tag section, i.e. a
+ * '[' line whose previous non-blank line is not a tag. A comment with a line
+ * starting with '[' inside movetext would fool this. */
+static size_t game_start_after(const char *data, size_t size, size_t from)
+{
+    size_t p = from;
+    while (p > 0 && data[p - 1] != '\n') p--;
+    int prev_tag = 1;
+    while (p < size) {
+        const char *line = data + p;
+        const char *nl = memchr(line, '\n', size - p);
+        size_t len = nl ? (size_t)(nl - line) : size - p;
+        size_t i = 0;
+        while (i < len && pgn_space(line[i])) i++;
+        if (i < len) {
+            int is_tag = line[i] == '[';
+            if (is_tag && !prev_tag) return p;
+            prev_tag = is_tag;
+        }
+        p += nl ? len + 1 : len;
+    }
+    return size;
+}
+
+size_t pgn_split(const char *data, size_t size, size_t *starts, size_t parts)
+{
+    if (parts == 0) return 0;
+    size_t n = 0;
+    starts[n++] = 0;
+    for (size_t i = 1; i < parts; ++i) {
+        size_t s = game_start_after(data, size, size / parts * i);
+        if (s < size && s > starts[n - 1]) starts[n++] = s;
+    }
+    return n;
+}
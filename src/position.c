@@ -1,6 +1,9 @@
 #include "position.h"
+#include "zobrist.h"
+#include "eval.h"
+#include "nnue.h"
 #include <string.h> 
-#include <ctype.h>
+#include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -9,24 +12,56 @@ void position_init(Position *pos)
     if (pos == NULL) return;
 
     memset(pos->board, 0, sizeof pos->board);
+    memset(pos->type_bb, 0, sizeof pos->type_bb);
+    memset(pos->color_bb, 0, sizeof pos->color_bb);
+    pos->hash = 0;
+    pos->pawn_key = 0;
+    pos->psq_mg = 0;
+    pos->psq_eg = 0;
+    pos->phase = 0;
     pos->side_to_move = COLOR_WHITE;
     pos->castling = 0;
     pos->en_passant = POS_NO_SQUARE;
     pos->halfmove_clock = 0;
     pos->fullmove_number = 1;
+    pos->nnue = NULL;
 }
 
-static int piece_type_from_letter(char c)
+void position_sync_bitboards(Position *pos)
 {
-    switch (c) {
-    case 'p': case 'P': return PIECE_PAWN;
-    case 'n': case 'N': return PIECE_KNIGHT;
-    case 'b': case 'B': return PIECE_BISHOP;
-    case 'r': case 'R': return PIECE_ROOK;
-    case 'q': case 'Q': return PIECE_QUEEN;
-    case 'k': case 'K': return PIECE_KING;
-    default: return 0;
+    if (pos == NULL) return;
+
+    memset(pos->type_bb, 0, sizeof pos->type_bb);
+    memset(pos->color_bb, 0, sizeof pos->color_bb);
+    for (int sq = 0; sq < 64; ++sq) {
+        int8_t v = pos->board[sq];
+        if (v == PIECE_EMPTY) continue;
+        int a = piece_abs(v);
+        if (a > PIECE_KING) continue;
+        pos->type_bb[a] |= 1ULL << sq;
+        pos->color_bb[piece_color(v)] |= 1ULL << sq;
     }
+    eval_refresh(pos);
+    nnue_refresh(pos);
+}
+
+/* Signed board value for each FEN piece letter, 0 for anything else; replaces
+ * isalpha/isupper so parsing does not depend on the locale. */
+static const int8_t fen_piece_value[256] = {
+    ['P'] = PIECE_PAWN, ['N'] = PIECE_KNIGHT, ['B'] = PIECE_BISHOP,
+    ['R'] = PIECE_ROOK, ['Q'] = PIECE_QUEEN, ['K'] = PIECE_KING,
+    ['p'] = -PIECE_PAWN, ['n'] = -PIECE_KNIGHT, ['b'] = -PIECE_BISHOP,
+    ['r'] = -PIECE_ROOK, ['q'] = -PIECE_QUEEN, ['k'] = -PIECE_KING,
+};
+
+static inline int fen_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+static inline int fen_digit(char c)
+{
+    return c >= '0' && c <= '9';
 }
 
 int position_square_from_coords(char file_char, char rank_char)
@@ -52,65 +87,72 @@ void position_square_to_coords(int sq, char *buf, size_t buf_size)
     buf[2] = '\0';
 }
 
-static pos_error_t parse_placement_field(Position *pos,
-                                        const char *s,
-                                        const char **out,
-                                        char *errbuf, size_t errbuf_size)
+/* Fills board, bitboards and the evaluation accumulators, and returns the
+ * Zobrist keys of the pieces alone in *piece_key and *pawn_key. */
+static pos_error_t parse_placement_field(Position *pos, const char *s, const char *end, const char **out,
+                                         uint64_t *piece_key, uint64_t *pawn_key,
+                                         char *errbuf, size_t errbuf_size)
 {
-    if (pos == NULL || s == NULL) {
-        if (errbuf && errbuf_size) snprintf(errbuf, errbuf_size, "null argument");
-        return POS_ERR_INVALID_ARG;
-    }
-
     int rank = 7;
     int file = 0;
     const char *p = s;
+    uint64_t key = 0, pawns = 0;
 
-    while (*p && !isspace((unsigned char)*p)) {
+    while (p < end && !fen_space(*p)) {
         char ch = *p;
 
         if (ch == '/') {
             if (file != 8) {
                 if (errbuf && errbuf_size)
                     snprintf(errbuf, errbuf_size, "bad FEN: rank %d has %d files (expected 8)", 8 - rank, file);
+                *out = p;
                 return POS_ERR_BAD_FEN;
             }
             rank--;
             if (rank < 0) {
                 if (errbuf && errbuf_size) snprintf(errbuf, errbuf_size, "bad FEN: too many ranks");
+                *out = p;
                 return POS_ERR_BAD_FEN;
             }
             file = 0;
-        } else if (isdigit((unsigned char)ch)) {
+        } else if (fen_digit(ch)) {
             int n = ch - '0';
             if (n < 1 || n > 8) {
                 if (errbuf && errbuf_size) snprintf(errbuf, errbuf_size, "bad FEN: invalid digit '%c'", ch);
+                *out = p;
                 return POS_ERR_BAD_FEN;
             }
-            for (int i = 0; i < n; ++i) {
-                if (file >= 8) {
-                    if (errbuf && errbuf_size) snprintf(errbuf, errbuf_size, "bad FEN: too many files in rank %d", 8 - rank);
-                    return POS_ERR_BAD_FEN;
-                }
-                pos->board[rank * 8 + file] = PIECE_EMPTY;
-                file++;
+            if (file + n > 8) {
+                if (errbuf && errbuf_size) snprintf(errbuf, errbuf_size, "bad FEN: too many files in rank %d", 8 - rank);
+                *out = p;
+                return POS_ERR_BAD_FEN;
             }
-        } else if (isalpha((unsigned char)ch)) {
-            int pt = piece_type_from_letter(ch);
-            if (pt == 0) {
-                if (errbuf && errbuf_size) snprintf(errbuf, errbuf_size, "bad FEN: invalid piece letter '%c'", ch);
+            file += n;
+        } else {
+            int8_t val = fen_piece_value[(unsigned char)ch];
+            if (val == 0) {
+                if (errbuf && errbuf_size) {
+                    if ((ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z'))
+                        snprintf(errbuf, errbuf_size, "bad FEN: invalid piece letter '%c'", ch);
+                    else
+                        snprintf(errbuf, errbuf_size, "bad FEN: unexpected character '%c'", ch);
+                }
+                *out = p;
                 return POS_ERR_BAD_FEN;
             }
             if (file >= 8) {
                 if (errbuf && errbuf_size) snprintf(errbuf, errbuf_size, "bad FEN: too many files in rank %d", 8 - rank);
+                *out = p;
                 return POS_ERR_BAD_FEN;
             }
-            int8_t val = (isupper((unsigned char)ch) ? (int8_t)pt : (int8_t)-pt);
-            pos->board[rank * 8 + file] = val;
+            int sq = rank * 8 + file;
+            pos->board[sq] = val;
+            pos->type_bb[piece_abs(val)] |= 1ULL << sq;
+            pos->color_bb[val < 0] |= 1ULL << sq;
+            eval_add_piece(pos, sq, val);
+            key ^= zobrist_piece_key(val, sq);
+            if (val == PIECE_PAWN || val == -PIECE_PAWN) pawns ^= zobrist_piece_key(val, sq);
             file++;
-        } else {
-            if (errbuf && errbuf_size) snprintf(errbuf, errbuf_size, "bad FEN: unexpected character '%c'", ch);
-            return POS_ERR_BAD_FEN;
         }
 
         p++;
@@ -118,13 +160,33 @@ static pos_error_t parse_placement_field(Position *pos,
 
     if (rank != 0 || file != 8) {
         if (errbuf && errbuf_size) snprintf(errbuf, errbuf_size, "bad FEN: incomplete placement (rank=%d,file=%d)", rank, file);
+        *out = p;
         return POS_ERR_BAD_FEN;
     }
 
-    if (out) *out = p;
+    nnue_refresh(pos);
+    *piece_key = key;
+    *pawn_key = pawns;
+    *out = p;
     return POS_OK;
 }
 
+/* Parses an unsigned decimal field of at most max; no sign, no locale. */
+static int parse_counter(const char **pp, const char *end, uint32_t max, uint32_t *value)
+{
+    const char *p = *pp;
+    uint64_t v = 0;
+    if (p >= end || !fen_digit(*p)) return 0;
+    while (p < end && fen_digit(*p)) {
+        v = v * 10 + (uint64_t)(*p - '0');
+        if (v > max) return 0;
+        p++;
+    }
+    *value = (uint32_t)v;
+    *pp = p;
+    return 1;
+}
+
 pos_error_t position_validate(const Position *pos, char *errbuf, size_t errbuf_size)
 {
     if (pos == NULL) {
@@ -145,6 +207,20 @@ pos_error_t position_validate(const Position *pos, char *errbuf, size_t errbuf_s
         if (v == -PIECE_KING) black_kings++;
     }
 
+    uint64_t type_bb[7] = {0};
+    uint64_t color_bb[2] = {0};
+    for (int i = 0; i < 64; ++i) {
+        int8_t v = pos->board[i];
+        if (v == PIECE_EMPTY) continue;
+        type_bb[piece_abs(v)] |= 1ULL << i;
+        color_bb[piece_color(v)] |= 1ULL << i;
+    }
+    if (memcmp(type_bb, pos->type_bb, sizeof type_bb) != 0 ||
+        memcmp(color_bb, pos->color_bb, sizeof color_bb) != 0) {
+        if (errbuf && errbuf_size) snprintf(errbuf, errbuf_size, "bitboards out of sync with board");
+        return POS_ERR_INVARIANT;
+    }
+
     if (white_kings != 1 || black_kings != 1) {
         if (errbuf && errbuf_size)
             snprintf(errbuf, errbuf_size, "invalid king count: white=%d black=%d", white_kings, black_kings);
@@ -163,6 +239,26 @@ pos_error_t position_validate(const Position *pos, char *errbuf, size_t errbuf_s
         }
     }
 
+    if (pos->hash != zobrist_compute(pos)) {
+        if (errbuf && errbuf_size) snprintf(errbuf, errbuf_size, "hash key out of sync with position");
+        return POS_ERR_INVARIANT;
+    }
+
+    if (pos->pawn_key != zobrist_compute_pawns(pos)) {
+        if (errbuf && errbuf_size) snprintf(errbuf, errbuf_size, "pawn key out of sync with position");
+        return POS_ERR_INVARIANT;
+    }
+
+    Position fresh = *pos;
+    eval_refresh(&fresh);
+    NNUEAccumulator acc;
+    if (pos->nnue) nnue_accumulate(pos, &acc);
+    if (fresh.psq_mg != pos->psq_mg || fresh.psq_eg != pos->psq_eg || fresh.phase != pos->phase ||
+        (pos->nnue && memcmp(&acc, pos->nnue, sizeof acc) != 0)) {
+        if (errbuf && errbuf_size) snprintf(errbuf, errbuf_size, "evaluation accumulators out of sync with board");
+        return POS_ERR_INVARIANT;
+    }
+
     if (pos->fullmove_number < 1) {
         if (errbuf && errbuf_size) snprintf(errbuf, errbuf_size, "invalid fullmove number: %u", pos->fullmove_number);
         return POS_ERR_INVARIANT;
@@ -178,15 +274,44 @@ pos_error_t position_from_fen(Position *pos, const char *fen,
         if (errbuf && errbuf_size) snprintf(errbuf, errbuf_size, "null argument");
         return POS_ERR_INVALID_ARG;
     }
+    return position_from_fen_n(pos, fen, strlen(fen), 0, NULL, errbuf, errbuf_size);
+}
+
+static pos_error_t fen_fail(size_t *stop, ptrdiff_t offset, char *errbuf, size_t errbuf_size, const char *fmt, ...)
+{
+    if (errbuf && errbuf_size) {
+        va_list ap;
+        va_start(ap, fmt);
+        vsnprintf(errbuf, errbuf_size, fmt, ap);
+        va_end(ap);
+    }
+    if (stop) *stop = (size_t)offset;
+    return POS_ERR_BAD_FEN;
+}
+
+pos_error_t position_from_fen_n(Position *pos, const char *fen, size_t len, unsigned flags,
+                                size_t *stop, char *errbuf, size_t errbuf_size)
+{
+    if (pos == NULL || (fen == NULL && len > 0)) {
+        if (errbuf && errbuf_size) snprintf(errbuf, errbuf_size, "null argument");
+        return POS_ERR_INVALID_ARG;
+    }
 
     position_init(pos);
 
     const char *p = fen;
-    pos_error_t r = parse_placement_field(pos, p, &p, errbuf, errbuf_size);
-    if (r != POS_OK) return r;
+    const char *end = fen + len;
+    uint64_t piece_key = 0;
+    pos_error_t r = parse_placement_field(pos, p, end, &p, &piece_key, &pos->pawn_key, errbuf, errbuf_size);
+    if (r != POS_OK) {
+        if (stop) *stop = (size_t)(p - fen);
+        return r;
+    }
+    pos->hash = piece_key ^ zobrist_castling[0];
 
-    while (*p && isspace((unsigned char)*p)) p++;
-    if (!*p) {
+    while (p < end && fen_space(*p)) p++;
+    if (p == end) {
+        if (stop) *stop = len;
         return POS_OK;
     }
 
@@ -197,22 +322,19 @@ pos_error_t position_from_fen(Position *pos, const char *fen,
         pos->side_to_move = COLOR_BLACK;
         p++;
     } else {
-        if (errbuf && errbuf_size) snprintf(errbuf, errbuf_size, "bad FEN: expected side-to-move 'w' or 'b'");
-        return POS_ERR_BAD_FEN;
+        return fen_fail(stop, p - fen, errbuf, errbuf_size, "bad FEN: expected side-to-move 'w' or 'b'");
     }
 
-    while (*p && isspace((unsigned char)*p)) p++;
-    if (!*p) {
-        if (errbuf && errbuf_size) snprintf(errbuf, errbuf_size, "bad FEN: missing fields after side-to-move");
-        return POS_ERR_BAD_FEN;
-    }
+    while (p < end && fen_space(*p)) p++;
+    if (p == end)
+        return fen_fail(stop, p - fen, errbuf, errbuf_size, "bad FEN: missing fields after side-to-move");
 
     if (*p == '-') {
         pos->castling = 0;
         p++;
     } else {
         uint8_t mask = 0;
-        while (*p && !isspace((unsigned char)*p)) {
+        while (p < end && !fen_space(*p)) {
             char c = *p;
             switch (c) {
             case 'K': mask |= CASTLE_WHITE_K; break;
@@ -220,73 +342,55 @@ pos_error_t position_from_fen(Position *pos, const char *fen,
             case 'k': mask |= CASTLE_BLACK_K; break;
             case 'q': mask |= CASTLE_BLACK_Q; break;
             default:
-                if (errbuf && errbuf_size) snprintf(errbuf, errbuf_size, "bad FEN: invalid castling char '%c'", c);
-                return POS_ERR_BAD_FEN;
+                return fen_fail(stop, p - fen, errbuf, errbuf_size, "bad FEN: invalid castling char '%c'", c);
             }
             p++;
         }
         pos->castling = mask;
     }
 
-    while (*p && isspace((unsigned char)*p)) p++;
-    if (!*p) {
-        if (errbuf && errbuf_size) snprintf(errbuf, errbuf_size, "bad FEN: missing fields after castling");
-        return POS_ERR_BAD_FEN;
-    }
+    while (p < end && fen_space(*p)) p++;
+    if (p == end)
+        return fen_fail(stop, p - fen, errbuf, errbuf_size, "bad FEN: missing fields after castling");
 
     if (*p == '-') {
         pos->en_passant = POS_NO_SQUARE;
         p++;
     } else {
-        if (!isalpha((unsigned char)p[0]) || !isdigit((unsigned char)p[1])) {
-            if (errbuf && errbuf_size) snprintf(errbuf, errbuf_size, "bad FEN: invalid en-passant '%c%c'", p[0], p[1]);
-            return POS_ERR_BAD_FEN;
-        }
-        int sq = position_square_from_coords((char)tolower((unsigned char)p[0]), p[1]);
-        if (sq == POS_NO_SQUARE) {
-            if (errbuf && errbuf_size) snprintf(errbuf, errbuf_size, "bad FEN: invalid en-passant square '%c%c'", p[0], p[1]);
-            return POS_ERR_BAD_FEN;
-        }
+        char f = end - p >= 2 ? p[0] : '\0', rk = end - p >= 2 ? p[1] : '\0';
+        if (f >= 'A' && f <= 'Z') f = (char)(f - 'A' + 'a');
+        int sq = position_square_from_coords(f, rk);
+        if (sq == POS_NO_SQUARE)
+            return fen_fail(stop, p - fen, errbuf, errbuf_size, "bad FEN: invalid en-passant square '%.*s'",
+                            end - p >= 2 ? 2 : 1, p);
         pos->en_passant = (int8_t)sq;
         p += 2;
     }
 
-    while (*p && isspace((unsigned char)*p)) p++;
-    if (!*p) {
-        if (errbuf && errbuf_size) snprintf(errbuf, errbuf_size, "bad FEN: missing halfmove/fullmove fields");
-        return POS_ERR_BAD_FEN;
-    }
-
-    {
-        char *endptr = NULL;
-        long v = strtol(p, &endptr, 10);
-        if (endptr == p || v < 0) {
-            if (errbuf && errbuf_size) snprintf(errbuf, errbuf_size, "bad FEN: invalid halfmove clock");
-            return POS_ERR_BAD_FEN;
-        }
+    const char *fields_end = p;
+    while (p < end && fen_space(*p)) p++;
+    if ((flags & FEN_EPD) && (p == end || !fen_digit(*p))) {
+        /* EPD: no clocks, operations (if any) follow */
+        p = fields_end;
+    } else {
+        uint32_t v;
+        if (p == end)
+            return fen_fail(stop, p - fen, errbuf, errbuf_size, "bad FEN: missing halfmove/fullmove fields");
+        if (!parse_counter(&p, end, UINT16_MAX, &v))
+            return fen_fail(stop, p - fen, errbuf, errbuf_size, "bad FEN: invalid halfmove clock");
         pos->halfmove_clock = (uint16_t)v;
-        p = endptr;
-    }
-
-    while (*p && isspace((unsigned char)*p)) p++;
-    if (!*p) {
-        if (errbuf && errbuf_size) snprintf(errbuf, errbuf_size, "bad FEN: missing fullmove number");
-        return POS_ERR_BAD_FEN;
-    }
 
-    {
-        char *endptr = NULL;
-        long v = strtol(p, &endptr, 10);
-        if (endptr == p || v < 1) {
-            if (errbuf && errbuf_size) snprintf(errbuf, errbuf_size, "bad FEN: invalid fullmove number");
-            return POS_ERR_BAD_FEN;
-        }
-        pos->fullmove_number = (uint32_t)v;
-        p = endptr;
+        while (p < end && fen_space(*p)) p++;
+        if (p == end) return fen_fail(stop, p - fen, errbuf, errbuf_size, "bad FEN: missing fullmove number");
+        if (!parse_counter(&p, end, UINT32_MAX, &v) || v < 1)
+            return fen_fail(stop, p - fen, errbuf, errbuf_size, "bad FEN: invalid fullmove number");
+        pos->fullmove_number = v;
     }
+    if (stop) *stop = (size_t)(p - fen);
 
-    r = position_validate(pos, errbuf, errbuf_size);
-    if (r != POS_OK) return r;
-
-    return POS_OK;
+    pos->hash = piece_key ^ zobrist_castling[pos->castling];
+    if (pos->en_passant != POS_NO_SQUARE) pos->hash ^= zobrist_ep_file[SQ_FILE(pos->en_passant)];
+    if (pos->side_to_move == COLOR_BLACK) pos->hash ^= zobrist_side;
+    if (flags & FEN_NO_VALIDATE) return POS_OK;
+    return position_validate(pos, errbuf, errbuf_size);
 }
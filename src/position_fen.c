@@ -1,111 +1,127 @@
 #include "position.h"
 #include <stdio.h>
-#include <stdarg.h>
 #include <string.h>
 #include <ctype.h>
 
-static int buf_appendf(char **dst, size_t *rem, const char *fmt, ...)
-{
-    if (*rem == 0) return -1;
-    va_list ap;
-    va_start(ap, fmt);
-    int n = vsnprintf(*dst, *rem, fmt, ap);
-    va_end(ap);
-    if (n < 0) return -1;
-    if ((size_t)n >= *rem) return -1; 
-    *dst += n;
-    *rem -= (size_t)n;
-    return 0;
-}
-
 static int piece_abs_val(int8_t v) { return v < 0 ? -v : v; }
 
-static char piece_value_to_letter(int8_t v)
+/* FEN letter for each board value, indexed by v + 6. */
+static const char fen_letter[13] = { 'k', 'q', 'r', 'b', 'n', 'p', '?', 'P', 'N', 'B', 'R', 'Q', 'K' };
+
+static char *write_u32(char *p, uint32_t v)
 {
-    int a = piece_abs_val(v);
-    char base;
-    switch (a) {
-    case PIECE_PAWN:   base = 'p'; break;
-    case PIECE_KNIGHT: base = 'n'; break;
-    case PIECE_BISHOP: base = 'b'; break;
-    case PIECE_ROOK:   base = 'r'; break;
-    case PIECE_QUEEN:  base = 'q'; break;
-    case PIECE_KING:   base = 'k'; break;
-    default: base = '?'; break;
-    }
-    return v > 0 ? (char) toupper((unsigned char)base) : base;
+    char digits[10];
+    int n = 0;
+    do {
+        digits[n++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    while (n) *p++ = digits[--n];
+    return p;
 }
 
-pos_error_t position_to_fen(const Position *pos, char *buf, size_t buf_size)
+/* Writes the FEN of pos (no NUL) into out, which must hold POS_FEN_MAX bytes,
+ * and returns its length. */
+static size_t write_fen(const Position *pos, char *out)
 {
-    if (pos == NULL || buf == NULL || buf_size == 0) return POS_ERR_INVALID_ARG;
-
-    char *p = buf;
-    size_t rem = buf_size;
-
+    char *p = out;
     for (int rank = 7; rank >= 0; --rank) {
+        const int8_t *row = pos->board + rank * 8;
         int empty_count = 0;
         for (int file = 0; file < 8; ++file) {
-            int idx = rank * 8 + file;
-            int8_t v = pos->board[idx];
+            int8_t v = row[file];
             if (v == PIECE_EMPTY) {
                 empty_count++;
-            } else {
-                if (empty_count > 0) {
-                    if (buf_appendf(&p, &rem, "%d", empty_count) != 0) return POS_ERR_BUF_SMALL;
-                    empty_count = 0;
-                }
-                char letter = piece_value_to_letter(v);
-                if (buf_appendf(&p, &rem, "%c", letter) != 0) return POS_ERR_BUF_SMALL;
+                continue;
             }
+            if (empty_count) {
+                *p++ = (char)('0' + empty_count);
+                empty_count = 0;
+            }
+            *p++ = piece_abs_val(v) <= PIECE_KING ? fen_letter[v + 6] : '?';
         }
-        if (empty_count > 0) {
-            if (buf_appendf(&p, &rem, "%d", empty_count) != 0) return POS_ERR_BUF_SMALL;
-        }
-        if (rank > 0) {
-            if (buf_appendf(&p, &rem, "/") != 0) return POS_ERR_BUF_SMALL;
-        }
-    }
-
-    if (buf_appendf(&p, &rem, " ") != 0) return POS_ERR_BUF_SMALL;
-
-    if (pos->side_to_move == COLOR_WHITE) {
-        if (buf_appendf(&p, &rem, "w") != 0) return POS_ERR_BUF_SMALL;
-    } else {
-        if (buf_appendf(&p, &rem, "b") != 0) return POS_ERR_BUF_SMALL;
+        if (empty_count) *p++ = (char)('0' + empty_count);
+        if (rank > 0) *p++ = '/';
     }
 
-    if (buf_appendf(&p, &rem, " ") != 0) return POS_ERR_BUF_SMALL;
-
+    *p++ = ' ';
+    *p++ = pos->side_to_move == COLOR_WHITE ? 'w' : 'b';
+    *p++ = ' ';
     if (pos->castling == 0) {
-        if (buf_appendf(&p, &rem, "-") != 0) return POS_ERR_BUF_SMALL;
+        *p++ = '-';
     } else {
-        if (pos->castling & CASTLE_WHITE_K) if (buf_appendf(&p, &rem, "K") != 0) return POS_ERR_BUF_SMALL;
-        if (pos->castling & CASTLE_WHITE_Q) if (buf_appendf(&p, &rem, "Q") != 0) return POS_ERR_BUF_SMALL;
-        if (pos->castling & CASTLE_BLACK_K) if (buf_appendf(&p, &rem, "k") != 0) return POS_ERR_BUF_SMALL;
-        if (pos->castling & CASTLE_BLACK_Q) if (buf_appendf(&p, &rem, "q") != 0) return POS_ERR_BUF_SMALL;
+        if (pos->castling & CASTLE_WHITE_K) *p++ = 'K';
+        if (pos->castling & CASTLE_WHITE_Q) *p++ = 'Q';
+        if (pos->castling & CASTLE_BLACK_K) *p++ = 'k';
+        if (pos->castling & CASTLE_BLACK_Q) *p++ = 'q';
     }
-
-    if (buf_appendf(&p, &rem, " ") != 0) return POS_ERR_BUF_SMALL;
-
+    *p++ = ' ';
     if (pos->en_passant == POS_NO_SQUARE) {
-        if (buf_appendf(&p, &rem, "-") != 0) return POS_ERR_BUF_SMALL;
+        *p++ = '-';
     } else {
-        char sqbuf[3];
-        position_square_to_coords(pos->en_passant, sqbuf, sizeof sqbuf);
-        if (sqbuf[0] == '\0') return POS_ERR_INVALID_ARG;
-        if (buf_appendf(&p, &rem, "%s", sqbuf) != 0) return POS_ERR_BUF_SMALL;
+        *p++ = (char)('a' + SQ_FILE(pos->en_passant));
+        *p++ = (char)('1' + SQ_RANK(pos->en_passant));
     }
+    *p++ = ' ';
+    p = write_u32(p, pos->halfmove_clock);
+    *p++ = ' ';
+    p = write_u32(p, pos->fullmove_number);
+    return (size_t)(p - out);
+}
 
-    if (buf_appendf(&p, &rem, " ") != 0) return POS_ERR_BUF_SMALL;
-
-    if (buf_appendf(&p, &rem, "%u", pos->halfmove_clock) != 0) return POS_ERR_BUF_SMALL;
+pos_error_t position_to_fen(const Position *pos, char *buf, size_t buf_size)
+{
+    if (pos == NULL || buf == NULL || buf_size == 0) return POS_ERR_INVALID_ARG;
+    if (pos->en_passant != POS_NO_SQUARE && (pos->en_passant < 0 || pos->en_passant >= 64)) return POS_ERR_INVALID_ARG;
 
-    if (buf_appendf(&p, &rem, " ") != 0) return POS_ERR_BUF_SMALL;
+    if (buf_size >= POS_FEN_MAX) {
+        buf[write_fen(pos, buf)] = '\0';
+        return POS_OK;
+    }
+    char tmp[POS_FEN_MAX];
+    size_t len = write_fen(pos, tmp);
+    if (len >= buf_size) return POS_ERR_BUF_SMALL;
+    memcpy(buf, tmp, len);
+    buf[len] = '\0';
+    return POS_OK;
+}
 
-    if (buf_appendf(&p, &rem, "%u", pos->fullmove_number) != 0) return POS_ERR_BUF_SMALL;
+pos_error_t position_to_fen_batch(const Position *positions, size_t count, char *buf, size_t buf_size,
+                                  size_t *done, size_t *written)
+{
+    if (done) *done = 0;
+    if (written) *written = 0;
+    if ((positions == NULL && count > 0) || (buf == NULL && buf_size > 0)) return POS_ERR_INVALID_ARG;
 
-    return POS_OK;
+    char *p = buf;
+    size_t rem = buf_size;
+    pos_error_t r = POS_OK;
+    size_t i = 0;
+    for (; i < count; ++i) {
+        const Position *pos = &positions[i];
+        if (pos->en_passant != POS_NO_SQUARE && (pos->en_passant < 0 || pos->en_passant >= 64)) {
+            r = POS_ERR_INVALID_ARG;
+            break;
+        }
+        size_t len;
+        if (rem >= POS_FEN_MAX) {
+            len = write_fen(pos, p);
+        } else {
+            char tmp[POS_FEN_MAX];
+            len = write_fen(pos, tmp);
+            if (len + 1 > rem) {
+                r = POS_ERR_BUF_SMALL;
+                break;
+            }
+            memcpy(p, tmp, len);
+        }
+        p[len++] = '\n';
+        p += len;
+        rem -= len;
+    }
+    if (done) *done = i;
+    if (written) *written = (size_t)(p - buf);
+    return r;
 }
 
 void position_print_ascii(const Position *pos, FILE *out)
@@ -0,0 +1,435 @@
+#define _POSIX_C_SOURCE 200809L
+#include "search.h"
+#include "eval.h"
+#include "nnue.h"
+#include "timeman.h"
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define SEARCH_POLL_MASK 1023
+#define QSEARCH_DELTA_MARGIN 200
+#define HISTORY_MAX 16384
+
+/* Lazy SMP: helpers only share the transposition table, this stop flag and a node tally. */
+typedef struct {
+    atomic_bool stop;
+    _Atomic uint64_t helper_nodes;
+} SearchShared;
+
+typedef struct {
+    Position *pos;
+    Position root;
+    NNUEAccumulator *caller_nnue;   /* pos->nnue before the search attached its own stack */
+    SearchShared *shared;
+    int helper;
+    const SearchLimits *limits;
+    uint64_t nodes;
+    uint64_t tt_probes, tt_hits, tt_cutoffs;
+    double start;
+    double clock_start;         /* when the time limits began: start, or the end of pondering */
+    double deadline;            /* clock_start + movetime_ms, 0 = none */
+    int pondering;
+    int stopped;
+    int can_stop;
+    int seldepth;
+    int follow_pv;
+    uint64_t *keys;
+    int key_count;
+    int prev_pv_length;
+    Move prev_pv[SEARCH_MAX_PLY];
+    Move killers[SEARCH_MAX_PLY][2];
+    int32_t history[2][64 * 64];
+    PawnTable pawns;
+    int pv_length[SEARCH_MAX_PLY];
+    Move pv[SEARCH_MAX_PLY][SEARCH_MAX_PLY];
+    NNUEAccumulator nnue[SEARCH_MAX_PLY];
+} SearchState;
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+void search_limits_init(SearchLimits *limits)
+{
+    memset(limits, 0, sizeof *limits);
+}
+
+static uint64_t total_nodes(const SearchState *st)
+{
+    return st->nodes + (st->shared ? atomic_load_explicit(&st->shared->helper_nodes, memory_order_relaxed) : 0);
+}
+
+/* Helpers only listen to the main thread; the main thread owns every external limit. */
+static void check_limits(SearchState *st)
+{
+    const SearchLimits *l = st->limits;
+    if (st->helper) {
+        atomic_fetch_add_explicit(&st->shared->helper_nodes, SEARCH_POLL_MASK + 1, memory_order_relaxed);
+        if (atomic_load_explicit(&st->shared->stop, memory_order_relaxed)) st->stopped = 1;
+        return;
+    }
+    if (st->pondering && !atomic_load_explicit(l->ponder, memory_order_relaxed)) {
+        st->pondering = 0;
+        st->clock_start = now_seconds();
+        if (l->movetime_ms > 0) st->deadline = st->clock_start + (double)l->movetime_ms / 1000.0;
+    }
+    if (!st->can_stop) return;
+    if ((l->stop && atomic_load_explicit(l->stop, memory_order_relaxed)) ||
+        (l->nodes && total_nodes(st) >= l->nodes) ||
+        (!st->pondering && st->deadline > 0.0 && now_seconds() >= st->deadline))
+        st->stopped = 1;
+}
+
+/* Only positions since the last irreversible move can repeat, and only with the same side to move. */
+static int is_repetition(const SearchState *st)
+{
+    uint64_t key = st->pos->hash;
+    int oldest = st->key_count - 1 - st->pos->halfmove_clock;
+    if (oldest < 0) oldest = 0;
+    for (int i = st->key_count - 3; i >= oldest; i -= 2) {
+        if (st->keys[i] == key) return 1;
+    }
+    return 0;
+}
+
+/* Mate scores are stored relative to the node so they stay valid at any ply. */
+static inline int score_to_tt(int score, int ply)
+{
+    return score > SCORE_MATE_BOUND ? score + ply : score < -SCORE_MATE_BOUND ? score - ply : score;
+}
+
+static inline int score_from_tt(int score, int ply)
+{
+    return score > SCORE_MATE_BOUND ? score - ply : score < -SCORE_MATE_BOUND ? score + ply : score;
+}
+
+static inline int captured_value(const Position *pos, Move m)
+{
+    if (move_flag(m) == MOVE_FLAG_EN_PASSANT) return eval_piece_value[PIECE_PAWN];
+    return eval_piece_value[piece_abs(pos->board[move_to(m)])];
+}
+
+/*
+ * Quiescence: stand pat on the static eval and resolve captures and promotions.
+ * Out of check, captures that cannot lift the score to alpha (delta pruning),
+ * that lose material by SEE, and underpromotions are skipped. In check every
+ * evasion is searched so mates are still seen.
+ */
+static int qsearch(SearchState *st, int alpha, int beta, int ply)
+{
+    Position *pos = st->pos;
+    st->pv_length[ply] = ply;
+    if ((++st->nodes & SEARCH_POLL_MASK) == 0) check_limits(st);
+    if (st->stopped) return 0;
+    if (ply > st->seldepth) st->seldepth = ply;
+    if (ply >= SEARCH_MAX_PLY - 1) return evaluate_cached(pos, &st->pawns);
+
+    int in_check = position_in_check(pos);
+    int stand_pat = -SCORE_INFINITE;
+    MovePicker mp;
+    if (in_check) {
+        movepicker_init(&mp, pos, MOVE_NONE, NULL, NULL);
+    } else {
+        stand_pat = evaluate_cached(pos, &st->pawns);
+        if (stand_pat >= beta) return stand_pat;
+        if (stand_pat > alpha) alpha = stand_pat;
+        movepicker_init_tactical(&mp, pos, MOVE_NONE);
+    }
+
+    int best = stand_pat, searched = 0;
+    MoveUndo undo;
+    Move m;
+    while ((m = movepicker_next(&mp)) != MOVE_NONE) {
+        if (!in_check) {
+            if (mp.stage == PICK_BAD_CAPTURES) break;
+            int promo = move_promotion(m);
+            if (promo && promo != PIECE_QUEEN) continue;
+            int gain = captured_value(pos, m) + (promo ? eval_piece_value[promo] - eval_piece_value[PIECE_PAWN] : 0);
+            if (stand_pat + gain + QSEARCH_DELTA_MARGIN <= alpha) continue;
+        }
+        searched++;
+        make_move_packed(pos, m, &undo);
+        int score = -qsearch(st, -beta, -alpha, ply + 1);
+        unmake_move(pos, &undo);
+        if (st->stopped) return 0;
+
+        if (score > best) {
+            best = score;
+            if (score > alpha) {
+                alpha = score;
+                if (alpha >= beta) break;
+            }
+        }
+    }
+    if (in_check && searched == 0) return -SCORE_MATE + ply;
+    return best;
+}
+
+static inline int is_quiet(const Position *pos, Move m)
+{
+    return move_flag(m) != MOVE_FLAG_PROMOTION && move_flag(m) != MOVE_FLAG_EN_PASSANT &&
+           pos->board[move_to(m)] == PIECE_EMPTY;
+}
+
+/* History gravity: bonuses shrink as an entry nears HISTORY_MAX, so scores stay bounded. */
+static inline void history_update(int32_t *entry, int bonus)
+{
+    *entry += bonus - *entry * (bonus < 0 ? -bonus : bonus) / HISTORY_MAX;
+}
+
+static void update_quiet_stats(SearchState *st, int ply, int depth, Move best, const Move *tried, int tried_count)
+{
+    int32_t *history = st->history[st->pos->side_to_move];
+    int bonus = depth * depth < 1200 ? depth * depth : 1200;
+    history_update(&history[move_from(best) * 64 + move_to(best)], bonus);
+    for (int i = 0; i < tried_count; ++i)
+        history_update(&history[move_from(tried[i]) * 64 + move_to(tried[i])], -bonus);
+    if (st->killers[ply][0] != best) {
+        st->killers[ply][1] = st->killers[ply][0];
+        st->killers[ply][0] = best;
+    }
+}
+
+static int negamax(SearchState *st, int depth, int alpha, int beta, int ply)
+{
+    Position *pos = st->pos;
+    st->pv_length[ply] = ply;
+    if (ply > 0 && (pos->halfmove_clock >= 100 || is_repetition(st))) return 0;
+    if (depth <= 0) return qsearch(st, alpha, beta, ply);
+
+    if ((++st->nodes & SEARCH_POLL_MASK) == 0) check_limits(st);
+    if (st->stopped) return 0;
+    if (ply > st->seldepth) st->seldepth = ply;
+    if (ply >= SEARCH_MAX_PLY - 1) return evaluate_cached(pos, &st->pawns);
+
+    TTable *tt = st->limits->tt;
+    Move tt_move = MOVE_NONE;
+    if (tt) {
+        TTHit hit;
+        st->tt_probes++;
+        if (tt_probe(tt, pos->hash, &hit)) {
+            st->tt_hits++;
+            tt_move = hit.move;
+            int score = score_from_tt(hit.score, ply);
+            if (ply > 0 && hit.depth >= depth &&
+                (hit.bound == TT_BOUND_EXACT ||
+                 (hit.bound == TT_BOUND_LOWER && score >= beta) ||
+                 (hit.bound == TT_BOUND_UPPER && score <= alpha))) {
+                st->tt_cutoffs++;
+                return score;
+            }
+        }
+    }
+
+    Move hash_move = tt_move;
+    if (st->follow_pv) {
+        st->follow_pv = ply < st->prev_pv_length && move_is_legal(pos, st->prev_pv[ply]);
+        if (st->follow_pv) hash_move = st->prev_pv[ply];
+    }
+    MovePicker mp;
+    movepicker_init(&mp, pos, hash_move, st->killers[ply], st->history[pos->side_to_move]);
+
+    int alpha_orig = alpha;
+    int best = -SCORE_INFINITE, searched = 0, quiet_count = 0;
+    Move best_move = MOVE_NONE, m;
+    Move quiets[64];
+    MoveUndo undo;
+    while ((m = movepicker_next(&mp)) != MOVE_NONE) {
+        int quiet = is_quiet(pos, m);
+        searched++;
+        make_move_packed(pos, m, &undo);
+        if (tt) tt_prefetch(tt, pos->hash);
+        st->keys[st->key_count++] = pos->hash;
+        int score = -negamax(st, depth - 1, -beta, -alpha, ply + 1);
+        st->key_count--;
+        unmake_move(pos, &undo);
+        st->follow_pv = 0;
+        if (st->stopped) return 0;
+
+        if (score > best) {
+            best = score;
+            best_move = m;
+            if (score > alpha) {
+                alpha = score;
+                st->pv[ply][ply] = m;
+                memcpy(&st->pv[ply][ply + 1], &st->pv[ply + 1][ply + 1],
+                       sizeof(Move) * (size_t)(st->pv_length[ply + 1] - ply - 1));
+                st->pv_length[ply] = st->pv_length[ply + 1];
+                if (alpha >= beta) {
+                    if (quiet) update_quiet_stats(st, ply, depth, m, quiets, quiet_count);
+                    break;
+                }
+            }
+        }
+        if (quiet && quiet_count < 64) quiets[quiet_count++] = m;
+    }
+    if (searched == 0) return position_in_check(pos) ? -SCORE_MATE + ply : 0;
+
+    if (tt) {
+        int bound = best >= beta ? TT_BOUND_LOWER : best > alpha_orig ? TT_BOUND_EXACT : TT_BOUND_UPPER;
+        tt_store(tt, pos->hash, depth, bound, score_to_tt(best, ply), bound == TT_BOUND_UPPER ? MOVE_NONE : best_move);
+    }
+    return best;
+}
+
+static void copy_counters(const SearchState *st, SearchResult *result)
+{
+    result->nodes = total_nodes(st);
+    result->tt_probes = st->tt_probes;
+    result->tt_hits = st->tt_hits;
+    result->tt_cutoffs = st->tt_cutoffs;
+    result->pawn_probes = st->pawns.probes;
+    result->pawn_hits = st->pawns.hits;
+    result->seconds = now_seconds() - st->start;
+}
+
+static SearchState *search_state_create(Position *pos, const SearchLimits *limits, SearchShared *shared, int helper)
+{
+    /* aligned_alloc, not calloc: the accumulator stack needs 32-byte alignment */
+    SearchState *st = aligned_alloc(_Alignof(SearchState), sizeof *st);
+    if (!st) return NULL;
+    memset(st, 0, sizeof *st);
+    st->keys = malloc(sizeof *st->keys * (size_t)(limits->history_count + SEARCH_MAX_PLY + 1));
+    if (!st->keys) {
+        free(st);
+        return NULL;
+    }
+    if (limits->history_count > 0)
+        memcpy(st->keys, limits->history, sizeof *st->keys * (size_t)limits->history_count);
+    st->key_count = limits->history_count;
+    st->keys[st->key_count++] = pos->hash;
+    if (helper) {
+        st->root = *pos;
+        st->pos = &st->root;
+    } else {
+        st->pos = pos;
+    }
+    st->caller_nnue = st->pos->nnue;
+    nnue_attach(st->pos, st->nnue);
+    st->limits = limits;
+    st->shared = shared;
+    st->helper = helper;
+    st->start = now_seconds();
+    st->clock_start = st->start;
+    st->deadline = limits->movetime_ms > 0 ? st->start + (double)limits->movetime_ms / 1000.0 : 0.0;
+    st->pondering = limits->ponder && atomic_load(limits->ponder);
+    pawn_table_clear(&st->pawns);
+    return st;
+}
+
+static void search_state_destroy(SearchState *st)
+{
+    if (!st) return;
+    st->pos->nnue = st->caller_nnue;
+    free(st->keys);
+    free(st);
+}
+
+static int search_max_depth(const SearchLimits *limits)
+{
+    return limits->depth > 0 && limits->depth < SEARCH_MAX_PLY ? limits->depth : SEARCH_MAX_PLY - 1;
+}
+
+static int search_iteration(SearchState *st, int depth)
+{
+    st->follow_pv = 1;
+    st->seldepth = 0;
+    int score = negamax(st, depth, -SCORE_INFINITE, SCORE_INFINITE, 0);
+    if (!st->stopped) {
+        st->prev_pv_length = st->pv_length[0];
+        memcpy(st->prev_pv, st->pv[0], sizeof(Move) * (size_t)st->prev_pv_length);
+    }
+    return score;
+}
+
+/* Odd helpers run one ply deeper so the threads spread over different iterations. */
+static void *helper_main(void *arg)
+{
+    SearchState *st = arg;
+    int max_depth = search_max_depth(st->limits);
+    for (int depth = 1; depth <= max_depth && !st->stopped; ++depth) {
+        int d = depth + (st->helper & 1);
+        search_iteration(st, d < SEARCH_MAX_PLY - 1 ? d : depth);
+    }
+    atomic_fetch_add_explicit(&st->shared->helper_nodes, st->nodes & SEARCH_POLL_MASK, memory_order_relaxed);
+    return NULL;
+}
+
+Move search(Position *pos, const SearchLimits *limits, SearchResult *result)
+{
+    memset(result, 0, sizeof *result);
+    int helpers = limits->tt && limits->threads > 1 ? limits->threads - 1 : 0;
+    SearchShared shared;
+    atomic_init(&shared.stop, false);
+    atomic_init(&shared.helper_nodes, 0);
+    SearchState *st = search_state_create(pos, limits, helpers ? &shared : NULL, 0);
+    if (!st) return MOVE_NONE;
+    if (limits->tt) tt_new_search(limits->tt);
+
+    SearchState **helper_states = helpers ? calloc((size_t)helpers, sizeof *helper_states) : NULL;
+    pthread_t *threads = helpers ? malloc(sizeof *threads * (size_t)helpers) : NULL;
+    int started = 0;
+    if (helper_states && threads) {
+        for (; started < helpers; ++started) {
+            helper_states[started] = search_state_create(pos, limits, &shared, started + 1);
+            if (!helper_states[started] ||
+                pthread_create(&threads[started], NULL, helper_main, helper_states[started]) != 0) {
+                search_state_destroy(helper_states[started]);
+                break;
+            }
+        }
+    }
+
+    int max_depth = search_max_depth(limits);
+    int stable = 0;
+    for (int depth = 1; depth <= max_depth; ++depth) {
+        int score = search_iteration(st, depth);
+        if (st->stopped) break;
+
+        Move previous = result->best_move;
+        result->best_move = st->prev_pv_length > 0 ? st->prev_pv[0] : MOVE_NONE;
+        result->score = score;
+        result->depth = depth;
+        result->seldepth = st->seldepth;
+        result->pv_length = st->prev_pv_length;
+        memcpy(result->pv, st->prev_pv, sizeof(Move) * (size_t)st->prev_pv_length);
+        copy_counters(st, result);
+        if (limits->on_iteration) limits->on_iteration(result, limits->ctx);
+
+        st->can_stop = 1;
+        check_limits(st);
+        if (st->stopped || result->best_move == MOVE_NONE || score_is_mate(score)) break;
+        stable = depth > 1 && result->best_move == previous ? stable + 1 : 0;
+        if (limits->soft_ms > 0 && !st->pondering &&
+            (now_seconds() - st->clock_start) * 1000.0 >= (double)time_soft_limit(limits->soft_ms, stable))
+            break;
+    }
+
+    atomic_store_explicit(&shared.stop, true, memory_order_relaxed);
+    for (int i = 0; i < started; ++i) {
+        pthread_join(threads[i], NULL);
+        search_state_destroy(helper_states[i]);
+    }
+    free(threads);
+    free(helper_states);
+    copy_counters(st, result);
+    search_state_destroy(st);
+    return result->best_move;
+}
+
+int search_quiescence(Position *pos, int alpha, int beta, uint64_t *nodes)
+{
+    SearchLimits limits;
+    search_limits_init(&limits);
+    SearchState *st = search_state_create(pos, &limits, NULL, 0);
+    if (!st) return evaluate(pos);
+    int score = qsearch(st, alpha, beta, 0);
+    if (nodes) *nodes = st->nodes;
+    search_state_destroy(st);
+    return score;
+}
@@ -0,0 +1,33 @@
+#include "timeman.h"
+
+#define TIME_SUDDEN_DEATH_MOVES 40
+#define TIME_MAX_MOVES_TO_GO    50
+
+TimeBudget time_budget(int64_t time_left_ms, int64_t inc_ms, int moves_to_go, int64_t overhead_ms)
+{
+    TimeBudget b;
+    int64_t available = time_left_ms - overhead_ms;
+    if (available < 1) available = 1;
+    if (inc_ms < 0) inc_ms = 0;
+    int mtg = moves_to_go > 0 ? moves_to_go : TIME_SUDDEN_DEATH_MOVES;
+    if (mtg > TIME_MAX_MOVES_TO_GO) mtg = TIME_MAX_MOVES_TO_GO;
+
+    b.soft_ms = available / mtg + inc_ms * 3 / 4;
+    b.hard_ms = b.soft_ms * 5;
+    /* Never sink more than three quarters of the clock into one move. */
+    if (b.hard_ms > available * 3 / 4) b.hard_ms = available * 3 / 4;
+    if (b.hard_ms < 1) b.hard_ms = 1;
+    if (b.soft_ms > b.hard_ms) b.soft_ms = b.hard_ms;
+    if (b.soft_ms < 1) b.soft_ms = 1;
+    return b;
+}
+
+/* Percent of the soft budget, indexed by how many iterations the best move has held. */
+static const int stability_scale[5] = { 160, 120, 100, 80, 60 };
+
+int64_t time_soft_limit(int64_t soft_ms, int stable_iterations)
+{
+    if (stable_iterations < 0) stable_iterations = 0;
+    if (stable_iterations > 4) stable_iterations = 4;
+    return soft_ms * stability_scale[stable_iterations] / 100;
+}
@@ -0,0 +1,119 @@
+#include "tt.h"
+#include <stdlib.h>
+
+#define TT_GENERATION_MASK 63
+
+static inline uint64_t tt_pack(Move move, int score, int depth, int bound, int generation)
+{
+    if (depth < 0) depth = 0;
+    if (depth > 255) depth = 255;
+    return (uint64_t)move | (uint64_t)(uint16_t)(score + 32768) << 16 | (uint64_t)depth << 32 |
+           (uint64_t)bound << 40 | (uint64_t)(generation & TT_GENERATION_MASK) << 42;
+}
+
+static inline Move data_move(uint64_t data) { return (Move)(data & 0xFFFF); }
+static inline int data_score(uint64_t data) { return (int)((data >> 16) & 0xFFFF) - 32768; }
+static inline int data_depth(uint64_t data) { return (int)((data >> 32) & 0xFF); }
+static inline int data_bound(uint64_t data) { return (int)((data >> 40) & 3); }
+static inline int data_generation(uint64_t data) { return (int)((data >> 42) & TT_GENERATION_MASK); }
+
+TTable *tt_create(size_t megabytes)
+{
+    size_t bytes = megabytes ? megabytes << 20 : 1u << 20;
+    size_t count = 1;
+    while (count * 2 * sizeof(TTBucket) <= bytes) count *= 2;
+    TTable *tt = malloc(sizeof *tt);
+    if (!tt) return NULL;
+    tt->buckets = aligned_alloc(sizeof(TTBucket), count * sizeof(TTBucket));
+    if (!tt->buckets) {
+        free(tt);
+        return NULL;
+    }
+    tt->mask = count - 1;
+    tt_clear(tt);
+    return tt;
+}
+
+void tt_destroy(TTable *tt)
+{
+    if (!tt) return;
+    free(tt->buckets);
+    free(tt);
+}
+
+void tt_clear(TTable *tt)
+{
+    if (!tt) return;
+    for (size_t i = 0; i <= tt->mask; ++i) {
+        for (int j = 0; j < TT_BUCKET_ENTRIES; ++j) {
+            atomic_init(&tt->buckets[i].entries[j].check, 0);
+            atomic_init(&tt->buckets[i].entries[j].data, 0);
+        }
+    }
+    tt->generation = 0;
+}
+
+void tt_new_search(TTable *tt)
+{
+    tt->generation = (uint8_t)((tt->generation + 1) & TT_GENERATION_MASK);
+}
+
+int tt_probe(const TTable *tt, uint64_t key, TTHit *hit)
+{
+    TTBucket *b = tt_bucket(tt, key);
+    for (int i = 0; i < TT_BUCKET_ENTRIES; ++i) {
+        uint64_t data = atomic_load_explicit(&b->entries[i].data, memory_order_relaxed);
+        uint64_t check = atomic_load_explicit(&b->entries[i].check, memory_order_relaxed);
+        if (data == 0 || (check ^ data) != key) continue;
+        hit->move = data_move(data);
+        hit->score = data_score(data);
+        hit->depth = data_depth(data);
+        hit->bound = data_bound(data);
+        return 1;
+    }
+    return 0;
+}
+
+/*
+ * Overwrite the entry for the same key if there is one, otherwise the slot
+ * whose depth is least worth keeping once each search generation of age
+ * counts as eight plies.
+ */
+void tt_store(TTable *tt, uint64_t key, int depth, int bound, int score, Move move)
+{
+    TTBucket *b = tt_bucket(tt, key);
+    TTEntry *victim = &b->entries[0];
+    int victim_value = 1 << 30;
+    for (int i = 0; i < TT_BUCKET_ENTRIES; ++i) {
+        TTEntry *e = &b->entries[i];
+        uint64_t data = atomic_load_explicit(&e->data, memory_order_relaxed);
+        uint64_t check = atomic_load_explicit(&e->check, memory_order_relaxed);
+        if (data != 0 && (check ^ data) == key) {
+            if (move == MOVE_NONE) move = data_move(data);
+            victim = e;
+            break;
+        }
+        int age = (tt->generation - data_generation(data)) & TT_GENERATION_MASK;
+        int value = data == 0 ? -(1 << 29) : data_depth(data) - 8 * age;
+        if (value < victim_value) {
+            victim_value = value;
+            victim = e;
+        }
+    }
+    uint64_t data = tt_pack(move, score, depth, bound, tt->generation);
+    atomic_store_explicit(&victim->data, data, memory_order_relaxed);
+    atomic_store_explicit(&victim->check, key ^ data, memory_order_relaxed);
+}
+
+int tt_hashfull(const TTable *tt)
+{
+    size_t buckets = tt->mask + 1 < 250 ? tt->mask + 1 : 250;
+    int used = 0;
+    for (size_t i = 0; i < buckets; ++i) {
+        for (int j = 0; j < TT_BUCKET_ENTRIES; ++j) {
+            uint64_t data = atomic_load_explicit(&tt->buckets[i].entries[j].data, memory_order_relaxed);
+            if (data != 0 && data_generation(data) == tt->generation) used++;
+        }
+    }
+    return (int)(used * 1000 / (buckets * TT_BUCKET_ENTRIES));
+}
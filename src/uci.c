@@ -0,0 +1,375 @@
+#define _POSIX_C_SOURCE 200809L
+#include "uci.h"
+#include "position.h"
+#include "movegen.h"
+#include "search.h"
+#include "nnue.h"
+#include "timeman.h"
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define UCI_START_FEN "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1"
+#define UCI_MAX_HASH_MB 65536
+#define UCI_MAX_THREADS 256
+#define UCI_MAX_OVERHEAD_MS 5000
+
+typedef struct {
+    FILE *out;
+    pthread_mutex_t out_lock;
+
+    Position pos;
+    uint64_t *keys;             /* hashes of the positions played before pos */
+    int key_count, key_cap;
+
+    TTable *tt;
+    size_t hash_mb;
+    int threads;
+    int64_t overhead_ms;
+
+    pthread_t thread;
+    int searching;
+    int infinite;               /* hold bestmove until "stop" (or "ponderhit"), guarded by wait_lock */
+    atomic_bool stop;
+    atomic_bool ponder;         /* "go ponder" until "ponderhit" */
+    pthread_mutex_t wait_lock;
+    pthread_cond_t wait_cond;
+    Position search_pos;
+    SearchLimits limits;
+} UciEngine;
+
+static void uci_send(UciEngine *e, const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    pthread_mutex_lock(&e->out_lock);
+    vfprintf(e->out, fmt, ap);
+    fputc('\n', e->out);
+    fflush(e->out);
+    pthread_mutex_unlock(&e->out_lock);
+    va_end(ap);
+}
+
+static void print_iteration(const SearchResult *r, void *ctx)
+{
+    UciEngine *e = ctx;
+    char line[256 + SEARCH_MAX_PLY * 6];
+    int n;
+    if (score_is_mate(r->score)) n = snprintf(line, sizeof line, "info depth %d seldepth %d score mate %d", r->depth, r->seldepth, score_mate_in(r->score));
+    else n = snprintf(line, sizeof line, "info depth %d seldepth %d score cp %d", r->depth, r->seldepth, r->score);
+    n += snprintf(line + n, sizeof line - (size_t)n, " nodes %llu nps %.0f time %.0f", (unsigned long long)r->nodes,
+                  r->seconds > 0.0 ? (double)r->nodes / r->seconds : 0.0, r->seconds * 1000.0);
+    if (e->tt) n += snprintf(line + n, sizeof line - (size_t)n, " hashfull %d", tt_hashfull(e->tt));
+    n += snprintf(line + n, sizeof line - (size_t)n, " pv");
+    for (int i = 0; i < r->pv_length; ++i) {
+        line[n++] = ' ';
+        move_to_uci(r->pv[i], line + n);
+        n += (int)strlen(line + n);
+    }
+    uci_send(e, "%s", line);
+}
+
+static void *search_thread(void *arg)
+{
+    UciEngine *e = arg;
+    SearchResult result;
+    Move best = search(&e->search_pos, &e->limits, &result);
+    pthread_mutex_lock(&e->wait_lock);
+    while (e->infinite && !atomic_load(&e->stop)) pthread_cond_wait(&e->wait_cond, &e->wait_lock);
+    pthread_mutex_unlock(&e->wait_lock);
+    char mv[MOVE_UCI_MAX] = "0000", ponder[MOVE_UCI_MAX];
+    if (best != MOVE_NONE) move_to_uci(best, mv);
+    if (best != MOVE_NONE && result.pv_length > 1) {
+        move_to_uci(result.pv[1], ponder);
+        uci_send(e, "bestmove %s ponder %s", mv, ponder);
+    } else {
+        uci_send(e, "bestmove %s", mv);
+    }
+    return NULL;
+}
+
+static void stop_search(UciEngine *e)
+{
+    if (!e->searching) return;
+    pthread_mutex_lock(&e->wait_lock);
+    atomic_store(&e->stop, true);
+    pthread_cond_broadcast(&e->wait_cond);
+    pthread_mutex_unlock(&e->wait_lock);
+    pthread_join(e->thread, NULL);
+    e->searching = 0;
+}
+
+/* The opponent played the expected move: the ponder search becomes a normal
+ * one whose time limits start now. A search that already finished replies at once. */
+static void ponder_hit(UciEngine *e)
+{
+    if (!e->searching || !atomic_load(&e->ponder)) return;
+    pthread_mutex_lock(&e->wait_lock);
+    e->infinite = 0;
+    atomic_store(&e->ponder, false);
+    pthread_cond_broadcast(&e->wait_cond);
+    pthread_mutex_unlock(&e->wait_lock);
+}
+
+static int push_key(UciEngine *e, uint64_t key)
+{
+    if (e->key_count == e->key_cap) {
+        int cap = e->key_cap ? e->key_cap * 2 : 256;
+        uint64_t *keys = realloc(e->keys, sizeof *keys * (size_t)cap);
+        if (!keys) return 0;
+        e->keys = keys;
+        e->key_cap = cap;
+    }
+    e->keys[e->key_count++] = key;
+    return 1;
+}
+
+/* position startpos|fen <fen> [moves <m1> <m2> ...] */
+static void cmd_position(UciEngine *e, char *args)
+{
+    char *save = NULL;
+    char *tok = strtok_r(args, " \t", &save);
+    char fen[256] = UCI_START_FEN;
+    if (tok && strcmp(tok, "fen") == 0) {
+        size_t len = 0;
+        fen[0] = '\0';
+        while ((tok = strtok_r(NULL, " \t", &save)) && strcmp(tok, "moves") != 0) {
+            int n = snprintf(fen + len, sizeof fen - len, "%s%s", len ? " " : "", tok);
+            if (n < 0 || (size_t)n >= sizeof fen - len) {
+                uci_send(e, "info string fen too long");
+                return;
+            }
+            len += (size_t)n;
+        }
+    } else if (tok && strcmp(tok, "startpos") == 0) {
+        tok = strtok_r(NULL, " \t", &save);
+    } else {
+        uci_send(e, "info string expected startpos or fen");
+        return;
+    }
+
+    Position pos;
+    char err[256];
+    if (position_from_fen(&pos, fen, err, sizeof err) != POS_OK) {
+        uci_send(e, "info string %s", err);
+        return;
+    }
+    e->key_count = 0;
+    if (tok && strcmp(tok, "moves") == 0) {
+        while ((tok = strtok_r(NULL, " \t", &save))) {
+            Move m = move_from_uci(&pos, tok, strlen(tok));
+            if (m == MOVE_NONE) {
+                uci_send(e, "info string illegal move %s", tok);
+                break;
+            }
+            if (!push_key(e, pos.hash)) break;
+            MoveUndo undo;
+            make_move(&pos, move_from(m), move_to(m), move_promotion(m), &undo);
+        }
+    }
+    e->pos = pos;
+}
+
+static int64_t parse_i64(char **save)
+{
+    char *tok = strtok_r(NULL, " \t", save);
+    return tok ? strtoll(tok, NULL, 10) : 0;
+}
+
+/* go [depth N] [nodes N] [movetime MS] [wtime MS] [btime MS] [winc MS] [binc MS] [movestogo N] [infinite] [ponder] */
+static void cmd_go(UciEngine *e, char *args)
+{
+    SearchLimits *l = &e->limits;
+    search_limits_init(l);
+    int64_t time_left[2] = { -1, -1 }, inc[2] = { 0, 0 }, moves_to_go = 0;
+    int ponder = 0;
+    e->infinite = 0;
+    char *save = NULL;
+    for (char *tok = strtok_r(args, " \t", &save); tok; tok = strtok_r(NULL, " \t", &save)) {
+        if (strcmp(tok, "depth") == 0) l->depth = (int)parse_i64(&save);
+        else if (strcmp(tok, "nodes") == 0) l->nodes = (uint64_t)parse_i64(&save);
+        else if (strcmp(tok, "movetime") == 0) l->movetime_ms = parse_i64(&save);
+        else if (strcmp(tok, "wtime") == 0) time_left[COLOR_WHITE] = parse_i64(&save);
+        else if (strcmp(tok, "btime") == 0) time_left[COLOR_BLACK] = parse_i64(&save);
+        else if (strcmp(tok, "winc") == 0) inc[COLOR_WHITE] = parse_i64(&save);
+        else if (strcmp(tok, "binc") == 0) inc[COLOR_BLACK] = parse_i64(&save);
+        else if (strcmp(tok, "movestogo") == 0) moves_to_go = parse_i64(&save);
+        else if (strcmp(tok, "infinite") == 0) e->infinite = 1;
+        else if (strcmp(tok, "ponder") == 0) ponder = 1;
+    }
+
+    int us = e->pos.side_to_move;
+    if (e->infinite) {
+        l->movetime_ms = 0;
+    } else if (l->movetime_ms > 0) {
+        l->movetime_ms = l->movetime_ms > e->overhead_ms * 2 ? l->movetime_ms - e->overhead_ms : l->movetime_ms / 2 + 1;
+    } else if (time_left[us] >= 0) {
+        TimeBudget b = time_budget(time_left[us], inc[us], (int)moves_to_go, e->overhead_ms);
+        l->soft_ms = b.soft_ms;
+        l->movetime_ms = b.hard_ms;
+    }
+
+    /* Pondering keeps the budget for the move being pondered; search starts its clock at "ponderhit". */
+    if (ponder) e->infinite = 1;
+    atomic_store(&e->ponder, ponder);
+    atomic_store(&e->stop, false);
+    l->stop = &e->stop;
+    l->ponder = &e->ponder;
+    l->tt = e->tt;
+    l->threads = e->threads;
+    l->history = e->keys;
+    l->history_count = e->key_count;
+    l->on_iteration = print_iteration;
+    l->ctx = e;
+    e->search_pos = e->pos;
+    if (pthread_create(&e->thread, NULL, search_thread, e) != 0) {
+        uci_send(e, "info string cannot start search thread");
+        uci_send(e, "bestmove 0000");
+        return;
+    }
+    e->searching = 1;
+}
+
+static void cmd_setoption(UciEngine *e, char *args)
+{
+    char name[64] = "", value[1024] = "";
+    char *save = NULL, *tok = strtok_r(args, " \t", &save);
+    if (!tok || strcmp(tok, "name") != 0) return;
+    char *dst = name;
+    size_t cap = sizeof name;
+    while ((tok = strtok_r(NULL, " \t", &save))) {
+        if (dst == name && strcmp(tok, "value") == 0) {
+            dst = value;
+            cap = sizeof value;
+            continue;
+        }
+        size_t len = strlen(dst);
+        snprintf(dst + len, cap - len, "%s%s", len ? " " : "", tok);
+    }
+
+    if (strcmp(name, "Hash") == 0) {
+        long long mb = atoll(value);
+        if (mb < 1 || mb > UCI_MAX_HASH_MB) {
+            uci_send(e, "info string Hash must be 1..%d", UCI_MAX_HASH_MB);
+            return;
+        }
+        TTable *tt = tt_create((size_t)mb);
+        if (!tt) {
+            uci_send(e, "info string cannot allocate %lld MB, keeping %zu MB", mb, e->hash_mb);
+            return;
+        }
+        tt_destroy(e->tt);
+        e->tt = tt;
+        e->hash_mb = (size_t)mb;
+    } else if (strcmp(name, "Threads") == 0) {
+        int n = atoi(value);
+        if (n < 1 || n > UCI_MAX_THREADS) {
+            uci_send(e, "info string Threads must be 1..%d", UCI_MAX_THREADS);
+            return;
+        }
+        e->threads = n;
+    } else if (strcmp(name, "Move Overhead") == 0) {
+        long long ms = atoll(value);
+        if (ms < 0 || ms > UCI_MAX_OVERHEAD_MS) {
+            uci_send(e, "info string Move Overhead must be 0..%d", UCI_MAX_OVERHEAD_MS);
+            return;
+        }
+        e->overhead_ms = ms;
+    } else if (strcmp(name, "Ponder") == 0) {
+        /* the GUI decides when to send "go ponder"; nothing to configure */
+    } else if (strcmp(name, "Clear Hash") == 0) {
+        tt_clear(e->tt);
+    } else if (strcmp(name, "EvalFile") == 0) {
+        char err[256];
+        if (value[0] == '\0' || strcmp(value, "<empty>") == 0) {
+            nnue_unload();
+        } else if (nnue_load(value, err, sizeof err) != POS_OK) {
+            uci_send(e, "info string %s", err);
+            return;
+        }
+        position_sync_bitboards(&e->pos);
+    } else {
+        uci_send(e, "info string unknown option %s", name);
+    }
+}
+
+int uci_loop(FILE *in, FILE *out)
+{
+    UciEngine engine;
+    UciEngine *e = &engine;
+    memset(e, 0, sizeof *e);
+    e->out = out;
+    pthread_mutex_init(&e->out_lock, NULL);
+    pthread_mutex_init(&e->wait_lock, NULL);
+    pthread_cond_init(&e->wait_cond, NULL);
+    atomic_init(&e->stop, false);
+    atomic_init(&e->ponder, false);
+    e->hash_mb = UCI_DEFAULT_HASH_MB;
+    e->threads = 1;
+    e->overhead_ms = TIME_DEFAULT_OVERHEAD_MS;
+    e->tt = tt_create(e->hash_mb);
+    position_from_fen(&e->pos, UCI_START_FEN, NULL, 0);
+
+    char *line = NULL;
+    size_t line_cap = 0;
+    ssize_t len;
+    while ((len = getline(&line, &line_cap, in)) >= 0) {
+        while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r')) line[--len] = '\0';
+        char *args = line + strspn(line, " \t");
+        char *cmd = args;
+        args += strcspn(args, " \t");
+        if (*args) *args++ = '\0';
+
+        if (strcmp(cmd, "uci") == 0) {
+            uci_send(e, "id name %s", UCI_ENGINE_NAME);
+            uci_send(e, "id author the %s authors", UCI_ENGINE_NAME);
+            uci_send(e, "option name Hash type spin default %d min 1 max %d", UCI_DEFAULT_HASH_MB, UCI_MAX_HASH_MB);
+            uci_send(e, "option name Threads type spin default 1 min 1 max %d", UCI_MAX_THREADS);
+            uci_send(e, "option name Move Overhead type spin default %d min 0 max %d", TIME_DEFAULT_OVERHEAD_MS, UCI_MAX_OVERHEAD_MS);
+            uci_send(e, "option name Ponder type check default false");
+            uci_send(e, "option name Clear Hash type button");
+            uci_send(e, "option name EvalFile type string default <empty>");
+            uci_send(e, "uciok");
+        } else if (strcmp(cmd, "isready") == 0) {
+            uci_send(e, "readyok");
+        } else if (strcmp(cmd, "stop") == 0) {
+            stop_search(e);
+        } else if (strcmp(cmd, "ponderhit") == 0) {
+            ponder_hit(e);
+        } else if (strcmp(cmd, "quit") == 0) {
+            break;
+        } else if (strcmp(cmd, "go") == 0) {
+            stop_search(e);
+            cmd_go(e, args);
+        } else if (strcmp(cmd, "position") == 0) {
+            stop_search(e);
+            cmd_position(e, args);
+        } else if (strcmp(cmd, "setoption") == 0) {
+            stop_search(e);
+            cmd_setoption(e, args);
+        } else if (strcmp(cmd, "ucinewgame") == 0) {
+            stop_search(e);
+            tt_clear(e->tt);
+            position_from_fen(&e->pos, UCI_START_FEN, NULL, 0);
+            e->key_count = 0;
+        } else if (strcmp(cmd, "d") == 0) {
+            pthread_mutex_lock(&e->out_lock);
+            position_print_ascii(&e->pos, e->out);
+            fflush(e->out);
+            pthread_mutex_unlock(&e->out_lock);
+        } else if (*cmd) {
+            uci_send(e, "info string unknown command %s", cmd);
+        }
+    }
+
+    stop_search(e);
+    free(line);
+    free(e->keys);
+    tt_destroy(e->tt);
+    pthread_cond_destroy(&e->wait_cond);
+    pthread_mutex_destroy(&e->wait_lock);
+    pthread_mutex_destroy(&e->out_lock);
+    return 0;
+}
@@ -0,0 +1,7 @@
+#include <stdio.h>
+#include "uci.h"
+
+int main(void)
+{
+    return uci_loop(stdin, stdout);
+}
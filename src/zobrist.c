@@ -0,0 +1,58 @@
+#include "zobrist.h"
+#include "bitboard.h"
+
+uint64_t zobrist_piece[2][7][64];
+uint64_t zobrist_castling[16];
+uint64_t zobrist_ep_file[8];
+uint64_t zobrist_side;
+
+static uint64_t zobrist_rand(uint64_t *state)
+{
+    *state ^= *state >> 12;
+    *state ^= *state << 25;
+    *state ^= *state >> 27;
+    return *state * 0x2545F4914F6CDD1DULL;
+}
+
+void zobrist_init(void)
+{
+    uint64_t state = 0x9D39247E33776D41ULL;
+    for (int c = 0; c < 2; ++c)
+        for (int p = PIECE_PAWN; p <= PIECE_KING; ++p)
+            for (int sq = 0; sq < 64; ++sq)
+                zobrist_piece[c][p][sq] = zobrist_rand(&state);
+    for (int i = 0; i < 16; ++i) zobrist_castling[i] = i ? zobrist_rand(&state) : 0;
+    for (int f = 0; f < 8; ++f) zobrist_ep_file[f] = zobrist_rand(&state);
+    zobrist_side = zobrist_rand(&state);
+}
+
+__attribute__((constructor))
+static void zobrist_init_at_startup(void)
+{
+    zobrist_init();
+}
+
+uint64_t zobrist_compute(const Position *pos)
+{
+    uint64_t key = 0;
+    Bitboard occ = position_occupied(pos);
+    while (occ) {
+        int sq = bb_pop_lsb(&occ);
+        key ^= zobrist_piece_key(pos->board[sq], sq);
+    }
+    key ^= zobrist_castling[pos->castling & 15];
+    if (pos->en_passant != POS_NO_SQUARE) key ^= zobrist_ep_file[SQ_FILE(pos->en_passant)];
+    if (pos->side_to_move == COLOR_BLACK) key ^= zobrist_side;
+    return key;
+}
+
+uint64_t zobrist_compute_pawns(const Position *pos)
+{
+    uint64_t key = 0;
+    Bitboard pawns = pos->type_bb[PIECE_PAWN];
+    while (pawns) {
+        int sq = bb_pop_lsb(&pawns);
+        key ^= zobrist_piece_key(pos->board[sq], sq);
+    }
+    return key;
+}
@@ -0,0 +1,270 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "bitboard.h"
+#include "position.h"
+#include "movegen.h"
+
+#define MAX_TRIALS 101
+#define MAX_ROWS 32
+
+typedef struct {
+    const char *name;
+    const char *fen;
+    int perft_depth;
+    uint64_t perft_nodes;
+} BenchPosition;
+
+static const BenchPosition bench_positions[] = {
+    { "opening",    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 5, 4865609ULL },
+    { "middlegame", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10", 4, 3894594ULL },
+    { "endgame",    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 5, 674624ULL },
+    { "promotion",  "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1", 5, 3605103ULL },
+    { "castling",   "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 4, 4085603ULL },
+};
+
+#define BENCH_POSITION_COUNT (int)(sizeof bench_positions / sizeof bench_positions[0])
+
+enum { KERNEL_MOVEGEN, KERNEL_MAKE_UNMAKE, KERNEL_ATTACKS, KERNEL_PERFT, KERNEL_COUNT };
+
+static const char *kernel_names[KERNEL_COUNT] = { "movegen", "makeunmake", "attacks", "perft" };
+static const char *kernel_units[KERNEL_COUNT] = { "call", "move", "query", "node" };
+
+typedef struct {
+    char name[48];
+    const char *unit;
+    double samples[MAX_TRIALS];
+    double median, p10, p90;
+    int have_baseline;
+    double base_median, base_p10, base_p90;
+} BenchRow;
+
+static volatile uint64_t bench_sink;
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/* Each kernel returns the number of operations it performed; the caller divides time by it. */
+static uint64_t kernel_movegen(const Position *pos)
+{
+    MoveList list;
+    uint64_t sum = 0;
+    for (int i = 0; i < 20000; ++i) sum += (uint64_t)generate_legal_list(pos, &list);
+    bench_sink += sum;
+    return 20000;
+}
+
+static uint64_t kernel_make_unmake(const Position *pos)
+{
+    Position p = *pos;
+    MoveList list;
+    MoveUndo undo;
+    generate_legal_list(&p, &list);
+    for (int i = 0; i < 2000; ++i) {
+        for (int m = 0; m < list.count; ++m) {
+            make_move_packed(&p, list.moves[m], &undo);
+            bench_sink += p.hash;
+            unmake_move(&p, &undo);
+        }
+    }
+    return 2000ULL * (uint64_t)list.count;
+}
+
+static uint64_t kernel_attacks(const Position *pos)
+{
+    uint64_t sum = 0;
+    for (int i = 0; i < 2000; ++i) {
+        for (int sq = 0; sq < 64; ++sq)
+            sum += (uint64_t)(is_square_attacked(pos, sq, COLOR_WHITE) + is_square_attacked(pos, sq, COLOR_BLACK));
+    }
+    bench_sink += sum;
+    return 2000ULL * 128;
+}
+
+static uint64_t kernel_perft(const Position *pos, const BenchPosition *bp, int *mismatch)
+{
+    Position p = *pos;
+    uint64_t nodes = perft(&p, bp->perft_depth);
+    if (nodes != bp->perft_nodes) *mismatch = 1;
+    return nodes;
+}
+
+static int compare_double(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/* Nearest-rank percentile over an already sorted sample. */
+static double percentile(const double *sorted, int n, double pct)
+{
+    int rank = (int)(pct / 100.0 * n + 0.5);
+    if (rank < 1) rank = 1;
+    if (rank > n) rank = n;
+    return sorted[rank - 1];
+}
+
+static void summarize(BenchRow *row, int trials)
+{
+    double sorted[MAX_TRIALS];
+    memcpy(sorted, row->samples, sizeof(double) * (size_t)trials);
+    qsort(sorted, (size_t)trials, sizeof sorted[0], compare_double);
+    row->median = trials % 2 ? sorted[trials / 2] : (sorted[trials / 2 - 1] + sorted[trials / 2]) / 2.0;
+    row->p10 = percentile(sorted, trials, 10.0);
+    row->p90 = percentile(sorted, trials, 90.0);
+}
+
+/* Baseline format: one "<name> <median> <p10> <p90>" line per row, times in ns per op. */
+static int load_baseline(const char *path, BenchRow *rows, int count)
+{
+    FILE *in = fopen(path, "r");
+    if (!in) return 0;
+    char line[256], name[64];
+    double median, p10, p90;
+    while (fgets(line, sizeof line, in)) {
+        if (line[0] == '#' || sscanf(line, "%63s %lf %lf %lf", name, &median, &p10, &p90) != 4) continue;
+        for (int i = 0; i < count; ++i) {
+            if (strcmp(rows[i].name, name) != 0) continue;
+            rows[i].have_baseline = 1;
+            rows[i].base_median = median;
+            rows[i].base_p10 = p10;
+            rows[i].base_p90 = p90;
+        }
+    }
+    fclose(in);
+    return 1;
+}
+
+static int save_baseline(const char *path, const BenchRow *rows, int count, int trials)
+{
+    FILE *out = fopen(path, "w");
+    if (!out) return 0;
+    fprintf(out, "# bench baseline: ns per op, trials=%d, sliders=%s\n", trials, bitboard_slider_backend());
+    for (int i = 0; i < count; ++i)
+        fprintf(out, "%s %.4f %.4f %.4f\n", rows[i].name, rows[i].median, rows[i].p10, rows[i].p90);
+    fclose(out);
+    return 1;
+}
+
+/*
+ * A row only counts as faster or slower when the median moved by more than the
+ * threshold and the whole p10..p90 band moved past the baseline median.
+ */
+static const char *verdict(const BenchRow *row, double threshold_pct)
+{
+    double delta = (row->median - row->base_median) / row->base_median * 100.0;
+    if (delta > threshold_pct && row->p10 > row->base_median) return "slower";
+    if (delta < -threshold_pct && row->p90 < row->base_median) return "faster";
+    return "~";
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "Usage: %s [-n trials] [-w warmup] [-b baseline] [-o save_baseline] [-r threshold_pct] [-x]\n", prog);
+}
+
+int main(int argc, char **argv)
+{
+    int trials = 9, warmup = 2, strict = 0;
+    double threshold = 3.0;
+    const char *baseline_path = NULL, *save_path = NULL;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) trials = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-w") == 0 && i + 1 < argc) warmup = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-b") == 0 && i + 1 < argc) baseline_path = argv[++i];
+        else if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) save_path = argv[++i];
+        else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) threshold = atof(argv[++i]);
+        else if (strcmp(argv[i], "-x") == 0) strict = 1;
+        else { usage(argv[0]); return 2; }
+    }
+    if (trials < 1 || trials > MAX_TRIALS || warmup < 0) {
+        fprintf(stderr, "trials must be in 1..%d and warmup >= 0\n", MAX_TRIALS);
+        return 2;
+    }
+
+    Position positions[BENCH_POSITION_COUNT];
+    for (int p = 0; p < BENCH_POSITION_COUNT; ++p) {
+        char err[256];
+        if (position_from_fen(&positions[p], bench_positions[p].fen, err, sizeof err) != POS_OK) {
+            fprintf(stderr, "%s: position_from_fen failed: %s\n", bench_positions[p].name, err);
+            return 3;
+        }
+    }
+
+    static BenchRow rows[MAX_ROWS];
+    int row_count = 0;
+    for (int k = 0; k < KERNEL_COUNT; ++k) {
+        for (int p = 0; p < BENCH_POSITION_COUNT; ++p, ++row_count) {
+            snprintf(rows[row_count].name, sizeof rows[row_count].name, "%s/%s", kernel_names[k], bench_positions[p].name);
+            rows[row_count].unit = kernel_units[k];
+        }
+    }
+    int init_row = row_count++;
+    snprintf(rows[init_row].name, sizeof rows[init_row].name, "init/bitboard");
+    rows[init_row].unit = "call";
+
+    int mismatch = 0;
+    for (int t = -warmup; t < trials; ++t) {
+        for (int k = 0; k < KERNEL_COUNT; ++k) {
+            for (int p = 0; p < BENCH_POSITION_COUNT; ++p) {
+                double t0 = now_seconds();
+                uint64_t ops = 0;
+                switch (k) {
+                case KERNEL_MOVEGEN: ops = kernel_movegen(&positions[p]); break;
+                case KERNEL_MAKE_UNMAKE: ops = kernel_make_unmake(&positions[p]); break;
+                case KERNEL_ATTACKS: ops = kernel_attacks(&positions[p]); break;
+                case KERNEL_PERFT: ops = kernel_perft(&positions[p], &bench_positions[p], &mismatch); break;
+                }
+                double elapsed = now_seconds() - t0;
+                if (t >= 0) rows[k * BENCH_POSITION_COUNT + p].samples[t] = elapsed * 1e9 / (double)ops;
+            }
+        }
+        double t0 = now_seconds();
+        for (int i = 0; i < 5; ++i) bitboard_init();
+        if (t >= 0) rows[init_row].samples[t] = (now_seconds() - t0) * 1e9 / 5.0;
+    }
+    if (mismatch) {
+        fprintf(stderr, "perft node count mismatch: results are not comparable\n");
+        return 4;
+    }
+
+    for (int i = 0; i < row_count; ++i) summarize(&rows[i], trials);
+    int have_baseline = baseline_path && load_baseline(baseline_path, rows, row_count);
+    if (baseline_path && !have_baseline) fprintf(stderr, "no baseline at %s; reporting absolute numbers only\n", baseline_path);
+
+    printf("bench: trials=%d warmup=%d sliders=%s%s%s\n", trials, warmup, bitboard_slider_backend(),
+           have_baseline ? " baseline=" : "", have_baseline ? baseline_path : "");
+    printf("%-22s %12s %12s %12s %-6s %12s", "name", "median ns", "p10 ns", "p90 ns", "per", "Mops/s");
+    if (have_baseline) printf(" %12s %8s  %s", "base ns", "delta", "verdict");
+    printf("\n");
+
+    int slower = 0;
+    for (int i = 0; i < row_count; ++i) {
+        const BenchRow *r = &rows[i];
+        printf("%-22s %12.2f %12.2f %12.2f %-6s %12.4g", r->name, r->median, r->p10, r->p90, r->unit,
+               r->median > 0.0 ? 1e3 / r->median : 0.0);
+        if (have_baseline && r->have_baseline) {
+            const char *v = verdict(r, threshold);
+            if (strcmp(v, "slower") == 0) slower++;
+            printf(" %12.2f %+7.1f%%  %s", r->base_median,
+                   (r->median - r->base_median) / r->base_median * 100.0, v);
+        }
+        printf("\n");
+    }
+    if (have_baseline) printf("slower rows: %d (threshold %.1f%%)\n", slower, threshold);
+
+    if (save_path) {
+        if (!save_baseline(save_path, rows, row_count, trials)) {
+            fprintf(stderr, "cannot write %s\n", save_path);
+            return 3;
+        }
+        printf("baseline written to %s\n", save_path);
+    }
+    return strict && slower ? 1 : 0;
+}
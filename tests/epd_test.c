@@ -0,0 +1,178 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "position.h"
+#include "epd.h"
+
+static const char suite[] =
+    "# comment line, then a blank one\n"
+    "\n"
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1 ;D1 20 ;D2 400\r\n"
+    "  r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - bm e2a6; id \"kiwi; pete\";\n"
+    "rnbqkbnr/ppp1pppp/8/3pP3/8/8/PPPP1PPP/RNBQKBNR w KQkq d6 0 3\n"
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNX w KQkq - 0 1\n"
+    "8/8/8/8/8/8/8/8 w - - 0 1\n"
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - -";
+
+/* What each non-comment line of suite must give: the FEN position_from_fen
+ * accepts for it (NULL if it must fail), the error column, and one operand. */
+static const struct {
+    const char *fen;
+    size_t line, column;
+    const char *opcode, *operand;
+} expected[] = {
+    { "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1", 3, 0, "D2", "400" },
+    { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", 4, 0, "id", "\"kiwi; pete\"" },
+    { "rnbqkbnr/ppp1pppp/8/3pP3/8/8/PPPP1PPP/RNBQKBNR w KQkq d6 0 3", 5, 0, "bm", NULL },
+    { NULL, 6, 43, NULL, NULL },
+    { NULL, 7, 26, NULL, NULL },
+    { "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1", 8, 0, NULL, NULL },
+};
+
+static int same_position(const Position *a, const Position *b)
+{
+    return memcmp(a->board, b->board, sizeof a->board) == 0 && memcmp(a->type_bb, b->type_bb, sizeof a->type_bb) == 0 &&
+           memcmp(a->color_bb, b->color_bb, sizeof a->color_bb) == 0 && a->hash == b->hash &&
+           a->pawn_key == b->pawn_key && a->psq_mg == b->psq_mg && a->psq_eg == b->psq_eg && a->phase == b->phase &&
+           a->side_to_move == b->side_to_move && a->castling == b->castling && a->en_passant == b->en_passant &&
+           a->halfmove_clock == b->halfmove_clock && a->fullmove_number == b->fullmove_number;
+}
+
+static int check_records(EpdReader *r, const char *what)
+{
+    int failures = 0;
+    size_t n = 0;
+    Position pos, want;
+    EpdRecord rec;
+    char err[256];
+    while (epd_next(r, &pos, &rec, err, sizeof err)) {
+        if (n == sizeof expected / sizeof expected[0]) {
+            printf("FAIL %s: extra record on line %zu\n", what, rec.line);
+            return failures + 1;
+        }
+        int ok = rec.line == expected[n].line;
+        if (expected[n].fen) {
+            ok = ok && rec.status == POS_OK && position_from_fen(&want, expected[n].fen, NULL, 0) == POS_OK &&
+                 same_position(&pos, &want);
+        } else {
+            ok = ok && rec.status != POS_OK && rec.error_column == expected[n].column;
+        }
+        if (expected[n].opcode) {
+            size_t len = 0;
+            const char *operand = epd_operand(&rec, expected[n].opcode, &len);
+            ok = ok && (expected[n].operand ? operand && len == strlen(expected[n].operand) &&
+                                                   memcmp(operand, expected[n].operand, len) == 0
+                                             : operand == NULL);
+        }
+        printf("%s %s line %zu: %s\n", ok ? "OK  " : "FAIL", what, rec.line,
+               rec.status == POS_OK ? "parsed" : err);
+        failures += !ok;
+        n++;
+    }
+    if (n != sizeof expected / sizeof expected[0]) {
+        printf("FAIL %s: %zu records\n", what, n);
+        failures++;
+    }
+    return failures;
+}
+
+/* position_from_fen_n must agree with position_from_fen on prefixes of a
+ * longer buffer, and FEN_NO_VALIDATE must let kingless positions through. */
+static int check_unterminated(void)
+{
+    static const char fen[] = "4k3/8/8/8/8/8/8/4K2R w K - 3 17";
+    static const char text[] = "4k3/8/8/8/8/8/8/4K2R w K - 3 17xxxxxxxx";
+    const size_t fen_len = sizeof fen - 1;
+    Position a, b;
+    size_t stop = 0;
+    int failures = 0;
+    if (position_from_fen_n(&a, text, fen_len, 0, &stop, NULL, 0) != POS_OK || stop != fen_len ||
+        position_from_fen(&b, fen, NULL, 0) != POS_OK || !same_position(&a, &b)) {
+        printf("FAIL unterminated buffer\n");
+        failures++;
+    }
+    if (position_from_fen_n(&a, text, fen_len - 3, 0, &stop, NULL, 0) != POS_ERR_BAD_FEN) {
+        printf("FAIL truncated buffer accepted\n");
+        failures++;
+    }
+    static const char empty_board[] = "8/8/8/8/8/8/8/8 w - - 0 1";
+    if (position_from_fen_n(&a, empty_board, sizeof empty_board - 1, FEN_NO_VALIDATE, NULL, NULL, 0) != POS_OK ||
+        position_from_fen_n(&a, empty_board, sizeof empty_board - 1, 0, NULL, NULL, 0) != POS_ERR_INVARIANT) {
+        printf("FAIL FEN_NO_VALIDATE\n");
+        failures++;
+    }
+    return failures;
+}
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/* Writes the suite to a temporary file, reads it back through the mapping,
+ * then times bulk parsing of a larger generated file. */
+static int check_file(void)
+{
+    char path[] = "/tmp/epd_testXXXXXX";
+    int failures = 0;
+    FILE *out = fdopen(mkstemp(path), "w");
+    if (!out) {
+        printf("FAIL cannot create temporary file\n");
+        return 1;
+    }
+    fputs(suite, out);
+    fclose(out);
+
+    EpdReader r;
+    char err[256];
+    if (epd_open(&r, path, 0, err, sizeof err) != POS_OK) {
+        printf("FAIL epd_open: %s\n", err);
+        remove(path);
+        return 1;
+    }
+    failures += check_records(&r, "file");
+    epd_close(&r);
+
+    enum { COPIES = 20000 };
+    out = fopen(path, "w");
+    for (int i = 0; i < COPIES; ++i) {
+        fputs("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1\n", out);
+        fputs("8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1 ;D1 14\n", out);
+    }
+    fclose(out);
+    for (int validate = 1; validate >= 0; --validate) {
+        if (epd_open(&r, path, validate ? 0 : FEN_NO_VALIDATE, err, sizeof err) != POS_OK) {
+            printf("FAIL epd_open: %s\n", err);
+            failures++;
+            break;
+        }
+        Position pos;
+        EpdRecord rec;
+        size_t good = 0, total = 0;
+        double t0 = now_seconds();
+        while (epd_next(&r, &pos, &rec, NULL, 0)) {
+            total++;
+            good += rec.status == POS_OK;
+        }
+        double seconds = now_seconds() - t0;
+        epd_close(&r);
+        printf("%s bulk parse%s: %zu/%zu records, %.0f records/s\n", good == 2 * COPIES ? "OK  " : "FAIL",
+               validate ? "" : " without validation", good, total, seconds > 0 ? (double)total / seconds : 0.0);
+        failures += good != 2 * COPIES;
+    }
+    remove(path);
+    return failures;
+}
+
+int main(void)
+{
+    EpdReader r;
+    epd_open_buffer(&r, suite, sizeof suite - 1, 0);
+    int failures = check_records(&r, "buffer") + check_unterminated() + check_file();
+    printf("%s (%d failures)\n", failures ? "epd tests FAILED" : "epd tests passed", failures);
+    return failures ? 1 : 0;
+}
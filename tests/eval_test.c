@@ -0,0 +1,133 @@
+#include <stdio.h>
+#include "position.h"
+#include "movegen.h"
+#include "eval.h"
+#include "pawns.h"
+#include "zobrist.h"
+
+static const char *eval_fens[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "rnbqkbnr/ppp1pppp/8/3pP3/8/8/PPPP1PPP/RNBQKBNR w KQkq d6 0 3",
+};
+
+static PawnTable pawn_table;
+
+/* Walk the legal tree and require the incremental accumulators and pawn key to
+ * match a full recompute after every make and every unmake, and the pawn-table
+ * lookup to match the uncached pawn terms. */
+static int check_tree(Position *pos, int depth, uint64_t *checked)
+{
+    Position fresh = *pos;
+    eval_refresh(&fresh);
+    if (fresh.psq_mg != pos->psq_mg || fresh.psq_eg != pos->psq_eg || fresh.phase != pos->phase) return 1;
+    if (pos->pawn_key != zobrist_compute_pawns(pos)) return 1;
+    if (evaluate_cached(pos, &pawn_table) != evaluate(pos)) return 1;
+    ++*checked;
+    if (depth == 0) return 0;
+
+    MoveList list;
+    generate_legal_list(pos, &list);
+    for (int i = 0; i < list.count; ++i) {
+        MoveUndo undo;
+        int16_t mg = pos->psq_mg, eg = pos->psq_eg;
+        uint8_t phase = pos->phase;
+        uint64_t pawn_key = pos->pawn_key;
+        make_move_packed(pos, list.moves[i], &undo);
+        int bad = check_tree(pos, depth - 1, checked);
+        unmake_move(pos, &undo);
+        if (bad || pos->psq_mg != mg || pos->psq_eg != eg || pos->phase != phase || pos->pawn_key != pawn_key) {
+            printf("  after move %d\n", list.moves[i]);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* Swapping colours and flipping ranks must negate the white-relative score,
+ * so evaluate() (side-to-move relative) is unchanged. */
+static int check_mirror(const Position *pos)
+{
+    Position mirror;
+    position_init(&mirror);
+    for (int sq = 0; sq < 64; ++sq) mirror.board[sq ^ 56] = (int8_t)-pos->board[sq];
+    mirror.side_to_move = pos->side_to_move ^ 1;
+    position_sync_bitboards(&mirror);
+    return evaluate(&mirror) != evaluate(pos);
+}
+
+/* Pawn-structure terms alone, as the difference from the same kings without
+ * pawns; none of these pawns stands on a king's shield files. */
+static const struct { const char *fen; int mg, eg; } pawn_cases[] = {
+    { "4k3/8/8/8/8/8/P7/4K3 w - - 0 1", 5 - 10, 10 - 15 },                  /* isolated passer on a2 */
+    { "4k3/8/8/8/8/P7/P7/4K3 w - - 0 1", 2 * -10 - 10 + 10, 2 * -15 - 20 + 20 }, /* doubled: only a3 is passed */
+    { "4k3/p7/8/8/8/8/P7/4K3 w - - 0 1", 0, 0 },                             /* symmetric, neither passed */
+    { "4k3/8/8/3p4/8/2P5/1P6/4K3 w - - 0 1", 5 + 10, 10 + 15 },           /* b2 passed, d5 isolated */
+    { "P3k3/8/8/8/8/8/8/4K3 w - - 0 1", -10, -15 },                         /* last-rank pawns have no stop square */
+    { "4k3/8/8/8/8/8/8/4K2p w - - 0 1", 10, 15 },
+};
+
+static int check_pawn_cases(void)
+{
+    int failures = 0;
+    for (size_t i = 0; i < sizeof pawn_cases / sizeof pawn_cases[0]; ++i) {
+        Position pos;
+        position_from_fen(&pos, pawn_cases[i].fen, NULL, 0);
+        int mg = 0, eg = 0, kings_mg = 0, kings_eg = 0;
+        pawn_evaluate(&pos, NULL, &mg, &eg);
+        for (int sq = 0; sq < 64; ++sq)
+            if (piece_abs(pos.board[sq]) == PIECE_PAWN) pos.board[sq] = PIECE_EMPTY;
+        position_sync_bitboards(&pos);
+        pawn_evaluate(&pos, NULL, &kings_mg, &kings_eg);
+        mg -= kings_mg;
+        eg -= kings_eg;
+        int ok = mg == pawn_cases[i].mg && eg == pawn_cases[i].eg;
+        printf("%s pawns %s: mg %d eg %d, expected %d %d\n", ok ? "OK  " : "FAIL", pawn_cases[i].fen, mg, eg,
+               pawn_cases[i].mg, pawn_cases[i].eg);
+        failures += !ok;
+    }
+    return failures;
+}
+
+int main(void)
+{
+    int failures = check_pawn_cases();
+    pawn_table_clear(&pawn_table);
+    for (size_t i = 0; i < sizeof eval_fens / sizeof eval_fens[0]; ++i) {
+        Position pos;
+        char err[256];
+        if (position_from_fen(&pos, eval_fens[i], err, sizeof err) != POS_OK) {
+            printf("FAIL %s: %s\n", eval_fens[i], err);
+            failures++;
+            continue;
+        }
+        uint64_t checked = 0;
+        if (check_tree(&pos, 3, &checked)) {
+            printf("FAIL %s: accumulators out of sync\n", eval_fens[i]);
+            failures++;
+            continue;
+        }
+        if (check_mirror(&pos)) {
+            printf("FAIL %s: mirrored position evaluates differently\n", eval_fens[i]);
+            failures++;
+            continue;
+        }
+        printf("OK   %s: eval %d, %llu nodes checked\n", eval_fens[i], evaluate(&pos), (unsigned long long)checked);
+    }
+
+    printf("pawn table: %llu probes, %.1f%% hits\n", (unsigned long long)pawn_table.probes,
+           pawn_table.probes ? 100.0 * (double)pawn_table.hits / (double)pawn_table.probes : 0.0);
+
+    Position start;
+    position_from_fen(&start, eval_fens[0], NULL, 0);
+    if (evaluate(&start) != 0 || start.phase != EVAL_PHASE_MAX) {
+        printf("FAIL start position: eval %d phase %d\n", evaluate(&start), start.phase);
+        failures++;
+    }
+
+    printf("%s (%d failures)\n", failures ? "eval tests FAILED" : "eval tests passed", failures);
+    return failures ? 1 : 0;
+}
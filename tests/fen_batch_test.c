@@ -0,0 +1,150 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "position.h"
+#include "movegen.h"
+
+#define MAX_POSITIONS 200000
+
+static const char *roots[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "rnbqkbnr/ppp1pppp/8/3pP3/8/8/PPPP1PPP/RNBQKBNR w KQkq d6 0 3",
+    "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 99 4000000000",
+};
+
+static Position positions[MAX_POSITIONS];
+static size_t position_count;
+
+static void collect(Position *pos, int depth)
+{
+    if (position_count == MAX_POSITIONS) return;
+    positions[position_count++] = *pos;
+    if (depth == 0) return;
+    MoveList list;
+    generate_legal_list(pos, &list);
+    for (int i = 0; i < list.count; ++i) {
+        MoveUndo undo;
+        make_move_packed(pos, list.moves[i], &undo);
+        collect(pos, depth - 1);
+        unmake_move(pos, &undo);
+    }
+}
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/* Every FEN must re-parse to the same position, fit a buffer of exactly its
+ * length + 1 and be refused by one byte less. */
+static int check_single(void)
+{
+    int failures = 0;
+    for (size_t i = 0; i < position_count && failures < 5; ++i) {
+        char fen[POS_FEN_MAX], small[POS_FEN_MAX];
+        Position back;
+        if (position_to_fen(&positions[i], fen, sizeof fen) != POS_OK ||
+            position_from_fen(&back, fen, NULL, 0) != POS_OK ||
+            memcmp(back.board, positions[i].board, sizeof back.board) != 0 || back.hash != positions[i].hash ||
+            back.halfmove_clock != positions[i].halfmove_clock ||
+            back.fullmove_number != positions[i].fullmove_number) {
+            printf("FAIL round trip: %s\n", fen);
+            failures++;
+            continue;
+        }
+        size_t len = strlen(fen);
+        if (position_to_fen(&positions[i], small, len + 1) != POS_OK || strcmp(small, fen) != 0 ||
+            position_to_fen(&positions[i], small, len) != POS_ERR_BUF_SMALL) {
+            printf("FAIL exact-size buffer: %s\n", fen);
+            failures++;
+        }
+    }
+    printf("%s %zu positions round-trip\n", failures ? "FAIL" : "OK  ", position_count);
+    return failures;
+}
+
+/* The batch output must equal the single FENs joined by newlines, both in one
+ * large buffer and when flushed through a small one. */
+static int check_batch(void)
+{
+    size_t size = position_count * POS_FEN_MAX;
+    char *expected = malloc(size), *out = malloc(size);
+    if (!expected || !out) return 1;
+    size_t expected_len = 0;
+    for (size_t i = 0; i < position_count; ++i) {
+        position_to_fen(&positions[i], expected + expected_len, POS_FEN_MAX);
+        expected_len += strlen(expected + expected_len);
+        expected[expected_len++] = '\n';
+    }
+
+    int failures = 0;
+    size_t done = 0, written = 0;
+    pos_error_t r = position_to_fen_batch(positions, position_count, out, size, &done, &written);
+    if (r != POS_OK || done != position_count || written != expected_len || memcmp(out, expected, written) != 0) {
+        printf("FAIL batch into one buffer\n");
+        failures++;
+    }
+
+    char chunk[300];
+    size_t total = 0, flushes = 0;
+    for (size_t next = 0; next < position_count; next += done) {
+        r = position_to_fen_batch(positions + next, position_count - next, chunk, sizeof chunk, &done, &written);
+        if ((r != POS_OK && r != POS_ERR_BUF_SMALL) || done == 0 || total + written > expected_len ||
+            memcmp(chunk, expected + total, written) != 0) {
+            printf("FAIL batch through a %zu-byte buffer at position %zu\n", sizeof chunk, next);
+            failures++;
+            break;
+        }
+        total += written;
+        flushes++;
+    }
+    if (!failures && total != expected_len) {
+        printf("FAIL batch through a small buffer: %zu of %zu bytes\n", total, expected_len);
+        failures++;
+    }
+    if (!failures) printf("OK   batch: %zu bytes, %zu flushes through %zu bytes\n", expected_len, flushes, sizeof chunk);
+
+    double t0 = now_seconds();
+    char fen[POS_FEN_MAX];
+    for (size_t i = 0; i < position_count; ++i) position_to_fen(&positions[i], fen, sizeof fen);
+    double single = now_seconds() - t0;
+    t0 = now_seconds();
+    position_to_fen_batch(positions, position_count, out, size, NULL, NULL);
+    double batch = now_seconds() - t0;
+    printf("serialize: %.0f FENs/s single, %.0f FENs/s batch\n", single > 0 ? (double)position_count / single : 0.0,
+           batch > 0 ? (double)position_count / batch : 0.0);
+
+    free(expected);
+    free(out);
+    return failures;
+}
+
+int main(void)
+{
+    for (size_t i = 0; i < sizeof roots / sizeof roots[0]; ++i) {
+        Position pos;
+        char err[256];
+        if (position_from_fen(&pos, roots[i], err, sizeof err) != POS_OK) {
+            printf("FAIL %s: %s\n", roots[i], err);
+            return 1;
+        }
+        collect(&pos, 3);
+    }
+    int failures = check_single() + check_batch();
+
+    Position bad = positions[0];
+    bad.en_passant = 64;
+    char fen[POS_FEN_MAX];
+    if (position_to_fen(&bad, fen, sizeof fen) != POS_ERR_INVALID_ARG) {
+        printf("FAIL out-of-range en-passant square accepted\n");
+        failures++;
+    }
+
+    printf("%s (%d failures)\n", failures ? "fen batch tests FAILED" : "fen batch tests passed", failures);
+    return failures ? 1 : 0;
+}
@@ -9,6 +9,7 @@ static int positions_equal(const Position *a, const Position *b)
     if (a->en_passant != b->en_passant) return 0;
     if (a->halfmove_clock != b->halfmove_clock) return 0;
     if (a->fullmove_number != b->fullmove_number) return 0;
+    if (a->hash != b->hash) return 0;
     for (int i = 0; i < 64; ++i) if (a->board[i] != b->board[i]) return 0;
     return 1;
 }
@@ -0,0 +1,84 @@
+#include <stdio.h>
+#include <string.h>
+#include "position.h"
+#include "movegen.h"
+
+static const char *fens[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "rnbqkbnr/ppp1pppp/8/3pP3/8/8/PPPP1PPP/RNBQKBNR w KQkq d6 0 3",
+    "8/8/8/2k5/2pP4/8/B7/4K3 b - d3 0 3",
+    "r3k2r/8/8/8/8/8/8/R3K2R b KQkq - 0 1",
+};
+
+static int in_list(const MoveList *list, Move m)
+{
+    for (int i = 0; i < list->count; ++i) {
+        if (list->moves[i] == m) return 1;
+    }
+    return 0;
+}
+
+/* Every 16-bit encoding is legal exactly when the generator produces it. */
+static int check_move_is_legal(const Position *pos, const MoveList *legal)
+{
+    for (unsigned v = 0; v <= 0xFFFF; ++v) {
+        Move m = (Move)v;
+        if (move_is_legal(pos, m) != in_list(legal, m)) {
+            printf("  move_is_legal(%04x) = %d, generator says %d\n", v, move_is_legal(pos, m), in_list(legal, m));
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* The picker yields each legal move once, the hash move first, and killers before other quiets. */
+static int check_picker(const Position *pos, const MoveList *legal)
+{
+    MoveList quiet;
+    generate_quiet_list(pos, &quiet);
+    Move hash = legal->count ? legal->moves[legal->count / 2] : MOVE_NONE;
+    Move killers[2] = { quiet.count > 1 ? quiet.moves[quiet.count - 1] : MOVE_NONE, move_encode(0, 63, 0, 0) };
+    int32_t history[64 * 64];
+    memset(history, 0, sizeof history);
+
+    MovePicker mp;
+    movepicker_init(&mp, pos, hash, killers, history);
+    MoveList seen = { .count = 0 };
+    Move m;
+    int killer_at = -1, first_quiet_at = -1;
+    while ((m = movepicker_next(&mp)) != MOVE_NONE) {
+        if (in_list(&seen, m) || !in_list(legal, m)) return 1;
+        if (m == killers[0] && m != hash) killer_at = seen.count;
+        else if (first_quiet_at < 0 && m != hash && in_list(&quiet, m)) first_quiet_at = seen.count;
+        seen.moves[seen.count++] = m;
+    }
+    if (seen.count != legal->count) return 1;
+    if (hash != MOVE_NONE && seen.moves[0] != hash) return 1;
+    if (killer_at >= 0 && first_quiet_at >= 0 && killer_at > first_quiet_at) return 1;
+    return 0;
+}
+
+int main(void)
+{
+    int failures = 0;
+    for (size_t i = 0; i < sizeof fens / sizeof fens[0]; ++i) {
+        Position pos;
+        char err[256];
+        if (position_from_fen(&pos, fens[i], err, sizeof err) != POS_OK) {
+            printf("FAIL %s: %s\n", fens[i], err);
+            failures++;
+            continue;
+        }
+        MoveList legal;
+        generate_legal_list(&pos, &legal);
+        int bad = check_move_is_legal(&pos, &legal) + check_picker(&pos, &legal);
+        printf("%s %s\n", bad ? "FAIL" : "OK  ", fens[i]);
+        failures += bad != 0;
+    }
+    printf("%s (%d failures)\n", failures ? "movepick tests FAILED" : "movepick tests passed", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,210 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "position.h"
+#include "movegen.h"
+#include "eval.h"
+#include "nnue.h"
+#include "perft.h"
+#include "search.h"
+#include "tt.h"
+
+static const char *nnue_fens[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1",
+    "rnbqkbnr/ppp1pppp/8/3pP3/8/8/PPPP1PPP/RNBQKBNR w KQkq d6 0 3",
+};
+
+static uint64_t rng_state = 0x9E3779B97F4A7C15ULL;
+
+static int rng_range(int lo, int hi)
+{
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return lo + (int)(rng_state % (uint64_t)(hi - lo + 1));
+}
+
+/* Straightforward float-free reference for the network output, independent of nnue.c's kernels. */
+static int reference_eval(const NNUENet *net, const Position *pos)
+{
+    int32_t hidden[2][NNUE_HIDDEN];
+    for (int p = 0; p < 2; ++p) {
+        for (int i = 0; i < NNUE_HIDDEN; ++i) hidden[p][i] = net->feature_bias[i];
+        for (int sq = 0; sq < 64; ++sq) {
+            int8_t v = pos->board[sq];
+            if (v == PIECE_EMPTY) continue;
+            for (int i = 0; i < NNUE_HIDDEN; ++i) hidden[p][i] += net->feature_weights[nnue_feature(p, v, sq)][i];
+        }
+    }
+    int64_t sum = net->output_bias;
+    for (int k = 0; k < 2; ++k) {
+        int p = k == 0 ? pos->side_to_move : pos->side_to_move ^ 1;
+        for (int i = 0; i < NNUE_HIDDEN; ++i) {
+            int32_t a = hidden[p][i] < 0 ? 0 : (hidden[p][i] > NNUE_QA ? NNUE_QA : hidden[p][i]);
+            sum += (int64_t)a * net->output_weights[k][i];
+        }
+    }
+    int64_t score = sum * NNUE_SCALE / (NNUE_QA * NNUE_QB);
+    return (int)(score > 20000 ? 20000 : (score < -20000 ? -20000 : score));
+}
+
+/* The incremental accumulator must equal a refresh after every make and
+ * unmake, and the vector output (attached or not) must equal the reference. */
+static int check_tree(const NNUENet *net, Position *pos, int depth, uint64_t *checked)
+{
+    NNUEAccumulator fresh;
+    nnue_accumulate(pos, &fresh);
+    if (memcmp(&fresh, pos->nnue, sizeof fresh) != 0) return 1;
+    Position detached = *pos;
+    detached.nnue = NULL;
+    int expected = reference_eval(net, pos);
+    if (nnue_evaluate(pos) != expected || nnue_evaluate(&detached) != expected) return 1;
+    ++*checked;
+    if (depth == 0) return 0;
+
+    MoveList list;
+    generate_legal_list(pos, &list);
+    for (int i = 0; i < list.count; ++i) {
+        MoveUndo undo;
+        NNUEAccumulator *top = pos->nnue, before = *top;
+        make_move_packed(pos, list.moves[i], &undo);
+        int bad = pos->nnue != top + 1 || check_tree(net, pos, depth - 1, checked);
+        unmake_move(pos, &undo);
+        if (bad || pos->nnue != top || memcmp(&before, top, sizeof before) != 0) {
+            printf("  after move %d\n", list.moves[i]);
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/* Each perspective sees the colour-swapped, rank-mirrored board the way the
+ * other sees the original, so any network scores the mirror identically. */
+static int check_mirror(const Position *pos)
+{
+    Position mirror;
+    position_init(&mirror);
+    for (int sq = 0; sq < 64; ++sq) mirror.board[sq ^ 56] = (int8_t)-pos->board[sq];
+    mirror.side_to_move = pos->side_to_move ^ 1;
+    position_sync_bitboards(&mirror);
+    return evaluate(&mirror) != evaluate(pos);
+}
+
+static int check_bad_files(const char *dir)
+{
+    char path[512], err[256];
+    int failures = 0;
+    snprintf(path, sizeof path, "%s/nnue_test_missing_%ld.bin", dir, (long)getpid());
+    if (nnue_load(path, err, sizeof err) == POS_OK) failures++;
+    snprintf(path, sizeof path, "%s/nnue_test_bad_%ld.bin", dir, (long)getpid());
+    FILE *out = fopen(path, "wb");
+    if (out) {
+        fputs("NNUE truncated", out);
+        fclose(out);
+        if (nnue_load(path, err, sizeof err) == POS_OK) failures++;
+        else printf("OK   rejected truncated file: %s\n", err);
+        remove(path);
+    }
+    return failures;
+}
+
+/* Helper threads and perft workers keep their Positions on the heap; the
+ * vector kernels must work on those copies too. */
+static int check_threads(void)
+{
+    Position pos;
+    position_from_fen(&pos, nnue_fens[1], NULL, 0);
+    int failures = 0;
+    uint64_t serial = perft(&pos, 4), parallel = perft_parallel(&pos, 4, 2);
+    if (serial != parallel) {
+        printf("FAIL parallel perft with a net: %llu != %llu\n", (unsigned long long)parallel,
+               (unsigned long long)serial);
+        failures++;
+    }
+
+    TTable *tt = tt_create(4);
+    if (!tt) return failures + 1;
+    SearchLimits limits;
+    search_limits_init(&limits);
+    limits.depth = 6;
+    limits.tt = tt;
+    limits.threads = 2;
+    SearchResult result;
+    Move best = search(&pos, &limits, &result);
+    tt_destroy(tt);
+    if (best == MOVE_NONE || result.depth < 6) {
+        printf("FAIL two-thread search with a net reached depth %d\n", result.depth);
+        failures++;
+    }
+    printf("%s threads: perft %llu, two-thread search depth %d\n", failures ? "FAIL" : "OK  ",
+           (unsigned long long)parallel, result.depth);
+    return failures;
+}
+
+int main(void)
+{
+    const char *dir = getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp";
+    char path[512], err[256];
+    snprintf(path, sizeof path, "%s/nnue_test_%ld.bin", dir, (long)getpid());
+
+    static NNUENet net;
+    for (int f = 0; f < NNUE_INPUTS; ++f)
+        for (int i = 0; i < NNUE_HIDDEN; ++i) net.feature_weights[f][i] = (int16_t)rng_range(-40, 40);
+    for (int i = 0; i < NNUE_HIDDEN; ++i) {
+        net.feature_bias[i] = (int16_t)rng_range(0, 120);
+        net.output_weights[0][i] = (int16_t)rng_range(-64, 64);
+        net.output_weights[1][i] = (int16_t)rng_range(-64, 64);
+    }
+    net.output_bias = rng_range(-5000, 5000);
+
+    int failures = check_bad_files(dir);
+    if (sizeof(Position) >= sizeof(NNUEAccumulator)) {
+        printf("FAIL Position carries an accumulator (%zu bytes)\n", sizeof(Position));
+        failures++;
+    }
+    if (nnue_save(&net, path, err, sizeof err) != POS_OK || nnue_load(path, err, sizeof err) != POS_OK) {
+        printf("FAIL save/load: %s\n", err);
+        return 1;
+    }
+    remove(path);
+    if (memcmp(nnue_net->feature_weights, net.feature_weights, sizeof net.feature_weights) != 0 ||
+        memcmp(nnue_net->feature_bias, net.feature_bias, sizeof net.feature_bias) != 0 ||
+        memcmp(nnue_net->output_weights, net.output_weights, sizeof net.output_weights) != 0 ||
+        nnue_net->output_bias != net.output_bias) {
+        printf("FAIL loaded network differs from the saved one\n");
+        failures++;
+    }
+
+    for (size_t i = 0; i < sizeof nnue_fens / sizeof nnue_fens[0]; ++i) {
+        Position pos;
+        if (position_from_fen(&pos, nnue_fens[i], err, sizeof err) != POS_OK) {
+            printf("FAIL %s: %s\n", nnue_fens[i], err);
+            failures++;
+            continue;
+        }
+        static NNUEAccumulator stack[4];
+        nnue_attach(&pos, stack);
+        uint64_t checked = 0;
+        if (check_tree(nnue_net, &pos, 3, &checked)) {
+            printf("FAIL %s: accumulator or output mismatch\n", nnue_fens[i]);
+            failures++;
+            continue;
+        }
+        if (check_mirror(&pos)) {
+            printf("FAIL %s: mirrored position evaluates differently\n", nnue_fens[i]);
+            failures++;
+            continue;
+        }
+        printf("OK   %s: nnue %d, %llu nodes checked\n", nnue_fens[i], evaluate(&pos), (unsigned long long)checked);
+    }
+    failures += check_threads();
+    nnue_unload();
+
+    printf("%s [%s] (%d failures)\n", failures ? "nnue tests FAILED" : "nnue tests passed", nnue_simd_backend(), failures);
+    return failures ? 1 : 0;
+}
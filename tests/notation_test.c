@@ -0,0 +1,118 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "position.h"
+#include "movegen.h"
+
+static const struct {
+    const char *fen, *uci, *san;
+} cases[] = {
+    { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", "e1c1", "O-O-O" },
+    { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", "e1g1", "O-O" },
+    { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", "e2a6", "Bxa6" },
+    { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", "e5f7", "Nxf7" },
+    { "4k3/8/8/8/8/8/8/1N3NK1 w - - 0 1", "b1d2", "Nbd2" },
+    { "4k3/8/8/R7/8/8/8/R5K1 w - - 0 1", "a1a3", "R1a3" },
+    { "6k1/8/8/8/8/Q7/8/Q1Q3K1 w - - 0 1", "a1b2", "Qa1b2" },
+    { "6k1/8/8/8/8/Q7/8/Q1Q3K1 w - - 0 1", "c1d2", "Qd2" },
+    { "rnbqkbnr/ppp1pppp/8/3pP3/8/8/PPPP1PPP/RNBQKBNR w KQkq d6 0 3", "e5d6", "exd6" },
+    { "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1", "g2f1q", "gxf1=Q+" },
+    { "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1", "g2g1n", "g1=N+" },
+    { "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1", "c8b6", "Ncb6" },
+    { "6k1/5ppp/8/8/8/8/5PPP/R5K1 w - - 0 1", "a1a8", "Ra8#" },
+    { "6k1/5ppp/8/8/8/8/5PPP/R5K1 w - - 0 1", "a1a9", NULL },
+    { "6k1/5ppp/8/8/8/8/5PPP/R5K1 w - - 0 1", "g1h1q", NULL },
+    { "6k1/5ppp/8/8/8/8/5PPP/R5K1 w - - 0 1", "f2f4", "f4" },
+    { "6k1/5ppp/8/8/8/8/5PPP/R5K1 w - - 0 1", "f2f5", NULL },
+};
+
+static const char *tree_roots[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1",
+};
+
+static int check_cases(void)
+{
+    int failures = 0;
+    for (size_t i = 0; i < sizeof cases / sizeof cases[0]; ++i) {
+        Position pos;
+        position_from_fen(&pos, cases[i].fen, NULL, 0);
+        Move m = move_from_uci(&pos, cases[i].uci, strlen(cases[i].uci));
+        char san[MOVE_SAN_MAX], uci[MOVE_UCI_MAX];
+        int ok;
+        if (cases[i].san) {
+            int len = move_to_san(&pos, m, san);
+            move_to_uci(m, uci);
+            ok = m != MOVE_NONE && strcmp(san, cases[i].san) == 0 && len == (int)strlen(san) &&
+                 strcmp(uci, cases[i].uci) == 0;
+        } else {
+            ok = m == MOVE_NONE && move_to_san(&pos, m, san) == 0 && san[0] == '\0';
+        }
+        printf("%s %s %s: %s\n", ok ? "OK  " : "FAIL", cases[i].fen, cases[i].uci, m != MOVE_NONE ? san : "rejected");
+        failures += !ok;
+    }
+    return failures;
+}
+
+/* Every legal move must format to text that parses back to it, and no two
+ * moves of a position may share a SAN string. */
+static int check_tree(Position *pos, int depth, uint64_t *moves)
+{
+    MoveList list;
+    generate_legal_list(pos, &list);
+    char sans[MOVELIST_CAPACITY][MOVE_SAN_MAX];
+    for (int i = 0; i < list.count; ++i) {
+        Move m = list.moves[i];
+        char uci[MOVE_UCI_MAX];
+        int len = move_to_san(pos, m, sans[i]);
+        move_to_uci(m, uci);
+        if (len == 0 || move_from_san(pos, sans[i], (size_t)len) != m || move_from_uci(pos, uci, strlen(uci)) != m) {
+            printf("  %s / %s does not round-trip\n", sans[i], uci);
+            return 1;
+        }
+        for (int j = 0; j < i; ++j) {
+            if (strcmp(sans[i], sans[j]) == 0) {
+                printf("  duplicate SAN %s\n", sans[i]);
+                return 1;
+            }
+        }
+        ++*moves;
+    }
+    if (depth <= 1) return 0;
+    for (int i = 0; i < list.count; ++i) {
+        MoveUndo undo;
+        make_move_packed(pos, list.moves[i], &undo);
+        int bad = check_tree(pos, depth - 1, moves);
+        unmake_move(pos, &undo);
+        if (bad) return 1;
+    }
+    return 0;
+}
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+int main(void)
+{
+    int failures = check_cases();
+    for (size_t i = 0; i < sizeof tree_roots / sizeof tree_roots[0]; ++i) {
+        Position pos;
+        position_from_fen(&pos, tree_roots[i], NULL, 0);
+        uint64_t moves = 0;
+        double t0 = now_seconds();
+        int bad = check_tree(&pos, 3, &moves);
+        double seconds = now_seconds() - t0;
+        printf("%s %s: %llu moves round-trip (%.0f moves/s)\n", bad ? "FAIL" : "OK  ", tree_roots[i],
+               (unsigned long long)moves, seconds > 0 ? (double)moves / seconds : 0.0);
+        failures += bad;
+    }
+    printf("%s (%d failures)\n", failures ? "notation tests FAILED" : "notation tests passed", failures);
+    return failures ? 1 : 0;
+}
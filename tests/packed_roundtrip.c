@@ -0,0 +1,168 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "position.h"
+#include "movegen.h"
+#include "packed.h"
+
+#define MAX_POSITIONS 50000
+
+static const char *roots[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "rnbqkbnr/ppp1pppp/8/3pP3/8/8/PPPP1PPP/RNBQKBNR w KQkq d6 0 3",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 65535 4294967295",
+};
+
+static Position positions[MAX_POSITIONS];
+static size_t position_count;
+
+static void collect(Position *pos, int depth)
+{
+    if (position_count == MAX_POSITIONS) return;
+    positions[position_count++] = *pos;
+    if (depth == 0) return;
+    MoveList list;
+    generate_legal_list(pos, &list);
+    for (int i = 0; i < list.count; ++i) {
+        MoveUndo undo;
+        make_move_packed(pos, list.moves[i], &undo);
+        collect(pos, depth - 1);
+        unmake_move(pos, &undo);
+    }
+}
+
+static int positions_equal(const Position *a, const Position *b)
+{
+    return memcmp(a->board, b->board, sizeof a->board) == 0 && memcmp(a->type_bb, b->type_bb, sizeof a->type_bb) == 0 &&
+           memcmp(a->color_bb, b->color_bb, sizeof a->color_bb) == 0 && a->hash == b->hash &&
+           a->pawn_key == b->pawn_key && a->psq_mg == b->psq_mg && a->psq_eg == b->psq_eg && a->phase == b->phase &&
+           a->side_to_move == b->side_to_move && a->castling == b->castling && a->en_passant == b->en_passant &&
+           a->halfmove_clock == b->halfmove_clock && a->fullmove_number == b->fullmove_number;
+}
+
+static int round_trip(const Position *pos)
+{
+    PackedPosition rec, again;
+    Position back;
+    char err[256];
+    if (position_pack(pos, &rec) != POS_OK) return 0;
+    if (position_unpack(&back, &rec, 0, err, sizeof err) != POS_OK) {
+        printf("  unpack: %s\n", err);
+        return 0;
+    }
+    return positions_equal(pos, &back) && position_pack(&back, &again) == POS_OK &&
+           memcmp(rec.bytes, again.bytes, sizeof rec.bytes) == 0;
+}
+
+static int check_rejects(void)
+{
+    int failures = 0;
+    PackedPosition rec;
+    Position pos;
+    position_from_fen(&pos, roots[0], NULL, 0);
+    position_pack(&pos, &rec);
+    rec.bytes[8] = 0x77;                        /* piece code 7 on a1 */
+    if (position_unpack(&pos, &rec, FEN_NO_VALIDATE, NULL, 0) == POS_OK) {
+        printf("FAIL bad piece code accepted\n");
+        failures++;
+    }
+    position_pack(&pos, &rec);
+    rec.bytes[25] = 64;
+    if (position_unpack(&pos, &rec, FEN_NO_VALIDATE, NULL, 0) == POS_OK) {
+        printf("FAIL bad en-passant square accepted\n");
+        failures++;
+    }
+    Position crowded;
+    position_from_fen(&crowded, "qqqqqqqk/qqqqqqqq/qqqqqqqq/qqqqqqqq/8/8/8/7K w - - 0 1", NULL, 0);
+    if (position_pack(&crowded, &rec) != POS_ERR_INVALID_ARG) {
+        printf("FAIL 33 pieces packed\n");
+        failures++;
+    }
+    return failures;
+}
+
+static int check_file(void)
+{
+    char path[] = "/tmp/packed_testXXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) return 1;
+    close(fd);
+
+    int failures = 0;
+    char err[256];
+    PackedFile f;
+    if (packed_file_write(path, positions, position_count, err, sizeof err) != POS_OK ||
+        packed_file_open(&f, path, err, sizeof err) != POS_OK) {
+        printf("FAIL packed file: %s\n", err);
+        remove(path);
+        return 1;
+    }
+    size_t bad = f.count == position_count ? 0 : 1;
+    for (size_t i = 0; i < f.count && i < position_count; ++i) {
+        Position pos;
+        if (position_unpack(&pos, &f.records[i], 0, NULL, 0) != POS_OK || !positions_equal(&pos, &positions[i])) bad++;
+    }
+    packed_file_close(&f);
+    printf("%s packed file: %zu records, %zu bytes each\n", bad ? "FAIL" : "OK  ", position_count,
+           (size_t)PACKED_POSITION_SIZE);
+    failures += bad != 0;
+
+    /* A file cut short inside its records must be refused. */
+    if (truncate(path, PACKED_FILE_HEADER_SIZE + PACKED_POSITION_SIZE) != 0 ||
+        packed_file_open(&f, path, err, sizeof err) == POS_OK) {
+        printf("FAIL truncated packed file accepted\n");
+        failures++;
+    }
+    remove(path);
+    return failures;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1) {
+        Position pos;
+        char err[256];
+        if (position_from_fen(&pos, argv[1], err, sizeof err) != POS_OK) {
+            fprintf(stderr, "parse failed: %s\n", err);
+            return 2;
+        }
+        if (!round_trip(&pos)) {
+            fprintf(stderr, "packed round-trip mismatch: %s\n", argv[1]);
+            return 5;
+        }
+        printf("OK: %s\n", argv[1]);
+        return 0;
+    }
+
+    for (size_t i = 0; i < sizeof roots / sizeof roots[0]; ++i) {
+        Position pos;
+        char err[256];
+        if (position_from_fen(&pos, roots[i], err, sizeof err) != POS_OK) {
+            printf("FAIL %s: %s\n", roots[i], err);
+            return 1;
+        }
+        collect(&pos, 3);
+    }
+
+    int failures = 0;
+    size_t fen_bytes = 0;
+    for (size_t i = 0; i < position_count; ++i) {
+        char fen[POS_FEN_MAX];
+        position_to_fen(&positions[i], fen, sizeof fen);
+        fen_bytes += strlen(fen) + 1;
+        if (!round_trip(&positions[i])) {
+            printf("FAIL round trip: %s\n", fen);
+            if (++failures == 5) break;
+        }
+    }
+    printf("%s %zu positions round-trip; %.1f FEN bytes per %d packed bytes\n", failures ? "FAIL" : "OK  ",
+           position_count, (double)fen_bytes / (double)position_count, PACKED_POSITION_SIZE);
+
+    failures += check_rejects() + check_file();
+    printf("%s (%d failures)\n", failures ? "packed tests FAILED" : "packed tests passed", failures);
+    return failures ? 1 : 0;
+}
@@ -1,18 +1,22 @@
+#define _POSIX_C_SOURCE 200809L
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
 #include "position.h"
 #include "movegen.h"
+#include "perft.h"
 
 static double now_seconds(void) {
-    return (double)clock() / (double)CLOCKS_PER_SEC;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
 }
 
 int main(int argc, char **argv)
 {
     if (argc < 3) {
-        fprintf(stderr, "Usage: %s <FEN> <depth> [expected]\n", argv[0]);
+        fprintf(stderr, "Usage: %s <FEN> <depth> [expected] [threads] [hash_mb]\n", argv[0]);
         return 2;
     }
 
@@ -20,10 +24,15 @@ int main(int argc, char **argv)
     int depth = atoi(argv[2]);
     unsigned long long expected = 0;
     int have_expected = 0;
-    if (argc >= 4) {
+    if (argc >= 4 && strcmp(argv[3], "-") != 0) {
         expected = strtoull(argv[3], NULL, 10);
         have_expected = 1;
     }
+    int threads = 1;
+    if (argc >= 5) {
+        threads = atoi(argv[4]);
+        if (threads <= 0) threads = perft_default_threads();
+    }
 
     Position pos;
     char err[256];
@@ -32,13 +41,25 @@ int main(int argc, char **argv)
         return 3;
     }
 
+    PerftTable *table = NULL;
+    if (argc >= 6 && atoi(argv[5]) > 0) {
+        table = perft_table_create((size_t)atoi(argv[5]));
+        if (!table) {
+            fprintf(stderr, "failed to allocate %s MB perft hash\n", argv[5]);
+            return 3;
+        }
+    }
+
     double t0 = now_seconds();
-    uint64_t nodes = perft(&pos, depth);
+    uint64_t nodes;
+    if (table) nodes = perft_hashed(&pos, depth, threads, table);
+    else nodes = threads > 1 ? perft_parallel(&pos, depth, threads) : perft(&pos, depth);
     double t1 = now_seconds();
+    perft_table_destroy(table);
 
     printf("FEN: %s\n", fen);
-    printf("Depth: %d  Nodes: %llu  Time: %.3fs  nps: %.0f\n",
-           depth, (unsigned long long)nodes, t1 - t0,
+    printf("Depth: %d  Threads: %d  Nodes: %llu  Time: %.3fs  nps: %.0f\n",
+           depth, threads, (unsigned long long)nodes, t1 - t0,
            (t1 - t0) > 0.0 ? (double)nodes / (t1 - t0) : (double)nodes);
 
     if (have_expected) {
@@ -0,0 +1,42 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "position.h"
+#include "perft.h"
+
+#define MAX_DEPTH 16
+
+int main(int argc, char **argv)
+{
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <FEN> <depth>\n", argv[0]);
+        return 2;
+    }
+    const char *fen = argv[1];
+    int depth = atoi(argv[2]);
+    if (depth < 1 || depth > MAX_DEPTH) {
+        fprintf(stderr, "depth must be in 1..%d\n", MAX_DEPTH);
+        return 2;
+    }
+    Position pos;
+    char err[256];
+    if (position_from_fen(&pos, fen, err, sizeof err) != POS_OK) {
+        fprintf(stderr, "position_from_fen failed: %s\n", err);
+        return 3;
+    }
+
+    PerftStats stats[MAX_DEPTH];
+    perft_detailed(&pos, depth, stats);
+
+    printf("FEN: %s\n", fen);
+    printf("%5s %14s %12s %10s %10s %10s %12s %10s\n",
+           "depth", "nodes", "captures", "e.p.", "castles", "promos", "checks", "mates");
+    for (int d = 0; d < depth; ++d) {
+        const PerftStats *s = &stats[d];
+        printf("%5d %14llu %12llu %10llu %10llu %10llu %12llu %10llu\n", d + 1,
+               (unsigned long long)s->nodes, (unsigned long long)s->captures,
+               (unsigned long long)s->en_passant, (unsigned long long)s->castles,
+               (unsigned long long)s->promotions, (unsigned long long)s->checks,
+               (unsigned long long)s->checkmates);
+    }
+    return 0;
+}
@@ -3,30 +3,18 @@
 #include <string.h>
 #include "position.h"
 #include "movegen.h"
-
-static void sq_to_coord(int sq, char *buf) {
-    if (sq < 0 || sq >= 64) { buf[0]='\0'; return; }
-    position_square_to_coords(sq, buf, 3);
-}
-
-static char promo_letter(int p) {
-    switch (p) {
-    case PIECE_QUEEN: return 'q';
-    case PIECE_ROOK:  return 'r';
-    case PIECE_BISHOP: return 'b';
-    case PIECE_KNIGHT: return 'n';
-    default: return '?';
-    }
-}
+#include "perft.h"
 
 int main(int argc, char **argv)
 {
     if (argc < 3) {
-        fprintf(stderr, "Usage: %s <FEN> <depth>\n", argv[0]);
+        fprintf(stderr, "Usage: %s <FEN> <depth> [threads]\n", argv[0]);
         return 2;
     }
     const char *fen = argv[1];
     int depth = atoi(argv[2]);
+    int threads = argc > 3 ? atoi(argv[3]) : 1;
+    if (threads <= 0) threads = perft_default_threads();
     Position pos;
     char err[256];
     if (position_from_fen(&pos, fen, err, sizeof err) != POS_OK) {
@@ -48,16 +36,11 @@ int main(int argc, char **argv)
         memcpy(&copy, &pos, sizeof(Position));
         MoveUndo undo;
         make_move(&copy, from[i], to[i], prom[i], &undo);
-        uint64_t nodes = perft(&copy, depth-1);
+        uint64_t nodes = perft_parallel(&copy, depth-1, threads);
         total += nodes;
-        char a[4], b[4];
-        sq_to_coord(from[i], a);
-        sq_to_coord(to[i], b);
-        if (prom[i] != 0) {
-            printf("%2d: %s%s%c -> %llu\n", i+1, a, b, promo_letter(prom[i]), (unsigned long long)nodes);
-        } else {
-            printf("%2d: %s%s -> %llu\n", i+1, a, b, (unsigned long long)nodes);
-        }
+        char mv[MOVE_UCI_MAX];
+        move_to_uci(move_from_squares(&pos, from[i], to[i], prom[i]), mv);
+        printf("%2d: %s -> %llu\n", i+1, mv, (unsigned long long)nodes);
     }
     printf("Total nodes: %llu\n", (unsigned long long)total);
 
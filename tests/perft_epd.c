@@ -0,0 +1,274 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "position.h"
+#include "movegen.h"
+#include "perft.h"
+
+#define MAX_DEPTHS 16
+
+typedef struct {
+    int depth;
+    uint64_t expected;
+    uint64_t nodes;
+    double seconds;
+} DepthResult;
+
+typedef struct {
+    int line;
+    char fen[128];
+    int depth_count;
+    DepthResult depths[MAX_DEPTHS];
+    char error[128];
+    double seconds;
+} SuiteEntry;
+
+typedef struct {
+    SuiteEntry *entries;
+    size_t count;
+    atomic_size_t next;
+    int max_depth;
+    PerftTable *table;
+} SuiteJob;
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static char *trim(char *s)
+{
+    while (*s == ' ' || *s == '\t') s++;
+    char *end = s + strlen(s);
+    while (end > s && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\n' || end[-1] == '\r')) end--;
+    *end = '\0';
+    return s;
+}
+
+static void set_fen(SuiteEntry *e, const char *fen)
+{
+    int fields = 0, in_field = 0;
+    for (const char *p = fen; *p; ++p) {
+        if (*p == ' ') in_field = 0;
+        else if (!in_field) { in_field = 1; fields++; }
+    }
+    snprintf(e->fen, sizeof e->fen, "%s%s", fen, fields == 4 ? " 0 1" : "");
+}
+
+/* Accepts EPD ("<fen> ;D1 20 ;D2 400") and the tab-separated "<fen>\t<depth>\t<expected>" form. */
+static int parse_line(char *line, int lineno, SuiteEntry *e)
+{
+    memset(e, 0, sizeof *e);
+    e->line = lineno;
+    char *hash = strchr(line, '#');
+    if (hash) *hash = '\0';
+    line = trim(line);
+    if (*line == '\0') return 0;
+
+    char *tab = strchr(line, '\t');
+    if (tab) {
+        *tab = '\0';
+        set_fen(e, trim(line));
+        char *end = NULL;
+        e->depths[0].depth = (int)strtol(tab + 1, &end, 10);
+        e->depths[0].expected = strtoull(end, NULL, 10);
+        e->depth_count = 1;
+        return 1;
+    }
+
+    char *semi = strchr(line, ';');
+    if (semi) *semi = '\0';
+    set_fen(e, trim(line));
+    while (semi && e->depth_count < MAX_DEPTHS) {
+        char *field = semi + 1;
+        semi = strchr(field, ';');
+        if (semi) *semi = '\0';
+        field = trim(field);
+        if (field[0] != 'D') continue;
+        char *end = NULL;
+        int depth = (int)strtol(field + 1, &end, 10);
+        if (end == field + 1 || depth < 1) continue;
+        e->depths[e->depth_count].depth = depth;
+        e->depths[e->depth_count].expected = strtoull(end, NULL, 10);
+        e->depth_count++;
+    }
+    return 1;
+}
+
+static void run_entry(SuiteEntry *e, int max_depth, PerftTable *table)
+{
+    Position pos;
+    if (position_from_fen(&pos, e->fen, e->error, sizeof e->error) != POS_OK) return;
+    double t0 = now_seconds();
+    for (int i = 0; i < e->depth_count; ++i) {
+        DepthResult *r = &e->depths[i];
+        if (max_depth > 0 && r->depth > max_depth) continue;
+        double t = now_seconds();
+        r->nodes = table ? perft_hashed(&pos, r->depth, 1, table) : perft(&pos, r->depth);
+        r->seconds = now_seconds() - t;
+    }
+    e->seconds = now_seconds() - t0;
+}
+
+static void *suite_worker(void *arg)
+{
+    SuiteJob *job = arg;
+    for (;;) {
+        size_t i = atomic_fetch_add_explicit(&job->next, 1, memory_order_relaxed);
+        if (i >= job->count) break;
+        run_entry(&job->entries[i], job->max_depth, job->table);
+    }
+    return NULL;
+}
+
+static int depth_skipped(const DepthResult *r, int max_depth)
+{
+    return max_depth > 0 && r->depth > max_depth;
+}
+
+static void json_string(FILE *out, const char *s)
+{
+    fputc('"', out);
+    for (; *s; ++s) {
+        if (*s == '"' || *s == '\\') fputc('\\', out);
+        if ((unsigned char)*s >= 0x20) fputc(*s, out);
+    }
+    fputc('"', out);
+}
+
+static void write_json(FILE *out, const SuiteJob *job, const char *suite, int threads,
+                       double seconds, uint64_t total_nodes, int mismatches)
+{
+    fprintf(out, "{\n  \"suite\": ");
+    json_string(out, suite);
+    fprintf(out, ",\n  \"threads\": %d,\n  \"positions\": [\n", threads);
+    for (size_t i = 0; i < job->count; ++i) {
+        const SuiteEntry *e = &job->entries[i];
+        fprintf(out, "    {\"line\": %d, \"fen\": ", e->line);
+        json_string(out, e->fen);
+        fprintf(out, ", \"seconds\": %.6f", e->seconds);
+        if (e->error[0]) {
+            fprintf(out, ", \"error\": ");
+            json_string(out, e->error);
+        }
+        fprintf(out, ", \"depths\": [");
+        int first = 1;
+        for (int d = 0; d < e->depth_count; ++d) {
+            const DepthResult *r = &e->depths[d];
+            if (depth_skipped(r, job->max_depth) || e->error[0]) continue;
+            fprintf(out, "%s{\"depth\": %d, \"expected\": %llu, \"nodes\": %llu, \"ok\": %s, "
+                         "\"seconds\": %.6f, \"nps\": %.0f}",
+                    first ? "" : ", ", r->depth, (unsigned long long)r->expected,
+                    (unsigned long long)r->nodes, r->nodes == r->expected ? "true" : "false",
+                    r->seconds, r->seconds > 0.0 ? (double)r->nodes / r->seconds : 0.0);
+            first = 0;
+        }
+        fprintf(out, "]}%s\n", i + 1 < job->count ? "," : "");
+    }
+    fprintf(out, "  ],\n  \"total_nodes\": %llu,\n  \"seconds\": %.6f,\n  \"nps\": %.0f,\n  \"mismatches\": %d\n}\n",
+            (unsigned long long)total_nodes, seconds,
+            seconds > 0.0 ? (double)total_nodes / seconds : 0.0, mismatches);
+}
+
+static void usage(const char *prog)
+{
+    fprintf(stderr, "Usage: %s [-t threads] [-d max_depth] [-H hash_mb] [-j out.json] <suite.epd>\n", prog);
+}
+
+int main(int argc, char **argv)
+{
+    int threads = 1, max_depth = 0, hash_mb = 0;
+    const char *json_path = NULL, *suite = NULL;
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) threads = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) max_depth = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-H") == 0 && i + 1 < argc) hash_mb = atoi(argv[++i]);
+        else if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) json_path = argv[++i];
+        else if (argv[i][0] == '-') { usage(argv[0]); return 2; }
+        else suite = argv[i];
+    }
+    if (!suite) { usage(argv[0]); return 2; }
+    if (threads <= 0) threads = perft_default_threads();
+
+    FILE *in = fopen(suite, "r");
+    if (!in) {
+        fprintf(stderr, "cannot open %s\n", suite);
+        return 3;
+    }
+    SuiteJob job;
+    memset(&job, 0, sizeof job);
+    size_t capacity = 0;
+    char line[1024];
+    int lineno = 0;
+    while (fgets(line, sizeof line, in)) {
+        lineno++;
+        if (job.count == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            SuiteEntry *grown = realloc(job.entries, capacity * sizeof *grown);
+            if (!grown) { fprintf(stderr, "alloc failed\n"); return 4; }
+            job.entries = grown;
+        }
+        if (parse_line(line, lineno, &job.entries[job.count])) job.count++;
+    }
+    fclose(in);
+    job.max_depth = max_depth;
+    atomic_init(&job.next, 0);
+    if (hash_mb > 0) job.table = perft_table_create((size_t)hash_mb);
+
+    double t0 = now_seconds();
+    pthread_t *workers = malloc(sizeof *workers * (size_t)threads);
+    int started = 0;
+    for (; workers && started < threads - 1; ++started) {
+        if (pthread_create(&workers[started], NULL, suite_worker, &job) != 0) break;
+    }
+    suite_worker(&job);
+    for (int i = 0; i < started; ++i) pthread_join(workers[i], NULL);
+    free(workers);
+    double seconds = now_seconds() - t0;
+
+    uint64_t total_nodes = 0;
+    int mismatches = 0;
+    for (size_t i = 0; i < job.count; ++i) {
+        const SuiteEntry *e = &job.entries[i];
+        if (e->error[0]) {
+            printf("line %d: ERROR %s\n", e->line, e->error);
+            mismatches++;
+            continue;
+        }
+        for (int d = 0; d < e->depth_count; ++d) {
+            const DepthResult *r = &e->depths[d];
+            if (depth_skipped(r, max_depth)) continue;
+            int ok = r->nodes == r->expected;
+            total_nodes += r->nodes;
+            if (!ok) mismatches++;
+            printf("line %3d D%-2d %12llu %8.3fs %12.0f nps  %s", e->line, r->depth,
+                   (unsigned long long)r->nodes, r->seconds,
+                   r->seconds > 0.0 ? (double)r->nodes / r->seconds : 0.0, ok ? "OK" : "MISMATCH");
+            if (!ok) printf(" (expected %llu) %s", (unsigned long long)r->expected, e->fen);
+            printf("\n");
+        }
+    }
+    printf("Positions: %zu  Nodes: %llu  Time: %.3fs  nps: %.0f  Threads: %d  Mismatches: %d\n",
+           job.count, (unsigned long long)total_nodes, seconds,
+           seconds > 0.0 ? (double)total_nodes / seconds : 0.0, threads, mismatches);
+
+    if (json_path) {
+        FILE *out = strcmp(json_path, "-") == 0 ? stdout : fopen(json_path, "w");
+        if (!out) {
+            fprintf(stderr, "cannot write %s\n", json_path);
+        } else {
+            write_json(out, &job, suite, threads, seconds, total_nodes, mismatches);
+            if (out != stdout) fclose(out);
+        }
+    }
+
+    perft_table_destroy(job.table);
+    free(job.entries);
+    return mismatches ? 1 : 0;
+}
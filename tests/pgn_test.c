@@ -0,0 +1,229 @@
+#define _POSIX_C_SOURCE 200809L
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "position.h"
+#include "movegen.h"
+#include "pgn.h"
+
+static const char games[] =
+    "% escaped line\n"
+    "[Event \"Paris \\\"Opera\\\"\"]\n"
+    "[White \"Morphy\"] [Black \"Duke Karl / Count Isouard\"]\n"
+    "[Result \"1-0\"]\n"
+    "\n"
+    "1. e4 e5 2. Nf3 d6 3. d4 Bg4 {This is a weak move\n"
+    "already.} 4. dxe5 Bxf3 (4... dxe5 5. Qxd8+ Kxd8 (5... Kxd8?) 6. Nxe5) 5. Qxf3 $1 dxe5\n"
+    "6. Bc4 Nf6 7. Qb3 Qe7 8. Nc3 c6 9. Bg5 b5 10. Nxb5 cxb5 11. Bxb5+ Nbd7 ; the only block\n"
+    "12. O-O-O Rd8 13. Rxd7 Rxd7 14. Rd1 Qe6 15. Bxd7+ Nxd7 16. Qb8+! Nxb8 17. Rd8# 1-0\n"
+    "\n"
+    "[Event \"Setup\"]\n"
+    "[SetUp \"1\"]\n"
+    "[FEN \"4k3/1P6/8/3pP3/8/8/8/R3K2R w KQ d6 0 1\"]\n"
+    "\n"
+    "1.exd6 e.p. Kd7 2.b8=N+ Kxd6 3.O-O Ke6 4.Rab1 Kd5 5.Rfd1+ Kc4 *\n"
+    "\n"
+    "[Event \"Illegal\"]\n"
+    "\n"
+    "1. e4 e5 2. Ke3 Nc6 3. Nf3 *\n"
+    "\n"
+    "[Event \"Bad FEN\"]\n"
+    "[FEN \"8/8/8/8/8/8/8/8 w - - 0 1\"]\n"
+    "\n"
+    "1. Ke2 *\n"
+    "\n"
+    "[Event \"No result\"]\n"
+    "1. d4 d5 2. c4 dxc4 3. e4 3... e5\n";
+
+static const struct {
+    const char *event;
+    int plies;
+    const char *result;
+    const char *fen;            /* after the last move, NULL to skip */
+    const char *error;          /* prefix of the error, NULL if none */
+} expected[] = {
+    { "Paris \\\"Opera\\\"", 33, "1-0", "1n1Rkb1r/p4ppp/4q3/4p1B1/4P3/8/PPP2PPP/2K5 b k - 1 17", NULL },
+    { "Setup", 10, "*", "1N6/8/8/8/2k5/8/8/1R1R2K1 w - - 6 6", NULL },
+    { "Illegal", 2, NULL, NULL, "line 19: illegal or ambiguous move 'Ke3' at ply 3" },
+    { "Bad FEN", 0, NULL, NULL, "line 21: FEN tag" },
+    { "No result", 6, NULL, "rnbqkbnr/ppp2ppp/8/4p3/2pPP3/8/PP3PPP/RNBQKBNR w KQkq e6 0 4", NULL },
+};
+
+static const struct {
+    const char *fen, *san, *uci;
+} san_cases[] = {
+    { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", "O-O-O", "e1c1" },
+    { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", "0-0", "e1g1" },
+    { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", "Bxa6", "e2a6" },
+    { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", "gxh3", "g2h3" },
+    { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", "Nb1", "c3b1" },
+    { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", "dxe6", "d5e6" },
+    { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", "Rd1", "a1d1" },
+    { "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1", "gxf1=Q+", "g2f1q" },
+    { "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1", "g1=N", "g2g1n" },
+    { "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1", "g1", NULL },
+    { "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1", "Nab6", "a8b6" },
+    { "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1", "Nb6", NULL },
+    { "4k3/8/8/8/8/8/8/R3K2R w - - 0 1", "Rhf1", "h1f1" },
+    { "4k3/8/8/8/8/8/4K3/R6R w - - 0 1", "Rd1", NULL },
+    { "4k3/8/8/8/8/8/4K3/R6R w - - 0 1", "Rad1", "a1d1" },
+    { "R3k3/8/8/8/8/8/8/R3K3 w - - 0 1", "R1a7", "a1a7" },
+    { "R3k3/8/8/8/8/8/8/R3K3 w - - 0 1", "Ra7", NULL },
+    { "rnbqkbnr/ppp1pppp/8/3pP3/8/8/PPPP1PPP/RNBQKBNR w KQkq d6 0 3", "exd6", "e5d6" },
+    { "rnbqkbnr/ppp1pppp/8/3pP3/8/8/PPPP1PPP/RNBQKBNR w KQkq d6 0 3", "e4", NULL },
+};
+
+static int check_san(void)
+{
+    int failures = 0;
+    for (size_t i = 0; i < sizeof san_cases / sizeof san_cases[0]; ++i) {
+        Position pos;
+        position_from_fen(&pos, san_cases[i].fen, NULL, 0);
+        Move m = move_from_san(&pos, san_cases[i].san, strlen(san_cases[i].san));
+        char got[MOVE_UCI_MAX];
+        move_to_uci(m, got);
+        int ok = strcmp(got, san_cases[i].uci ? san_cases[i].uci : "0000") == 0;
+        if (!ok) {
+            printf("FAIL san %s in %s: got %s\n", san_cases[i].san, san_cases[i].fen, got);
+            failures++;
+        }
+    }
+    printf("%s %zu SAN cases\n", failures ? "FAIL" : "OK  ", sizeof san_cases / sizeof san_cases[0]);
+    return failures;
+}
+
+static int check_games(void)
+{
+    PgnReader r;
+    PgnGame g;
+    pgn_open_buffer(&r, games, sizeof games - 1, 0);
+    int failures = 0;
+    size_t n = 0;
+    while (pgn_next_game(&r, &g)) {
+        if (n == sizeof expected / sizeof expected[0]) {
+            printf("FAIL extra game at line %zu\n", g.line);
+            return failures + 1;
+        }
+        while (pgn_next_move(&r, &g, NULL)) {}
+        size_t len = 0;
+        const char *event = pgn_tag(&g, "Event", &len);
+        char fen[POS_FEN_MAX];
+        position_to_fen(&g.pos, fen, sizeof fen);
+        int ok = event && len == strlen(expected[n].event) && memcmp(event, expected[n].event, len) == 0 &&
+                 g.plies == expected[n].plies;
+        ok = ok && (expected[n].result ? g.result && g.result_len == strlen(expected[n].result) &&
+                                             memcmp(g.result, expected[n].result, g.result_len) == 0
+                                       : g.result == NULL);
+        if (expected[n].fen) ok = ok && g.status == POS_OK && strcmp(fen, expected[n].fen) == 0;
+        if (expected[n].error)
+            ok = ok && g.status != POS_OK && strncmp(g.error, expected[n].error, strlen(expected[n].error)) == 0;
+        printf("%s game %zu (%.*s): %d plies, %s\n", ok ? "OK  " : "FAIL", n + 1, (int)len, event ? event : "",
+               g.plies, g.status == POS_OK ? fen : g.error);
+        failures += !ok;
+        n++;
+    }
+    if (n != sizeof expected / sizeof expected[0]) {
+        printf("FAIL %zu games read\n", n);
+        failures++;
+    }
+
+    /* Leaving moves unread must not disturb the next game. */
+    pgn_open_buffer(&r, games, sizeof games - 1, 0);
+    n = 0;
+    while (pgn_next_game(&r, &g)) n++;
+    if (n != sizeof expected / sizeof expected[0]) {
+        printf("FAIL %zu games when skipping movetext\n", n);
+        failures++;
+    }
+
+    Position mate;
+    pgn_open_buffer(&r, games, sizeof games - 1, 0);
+    pgn_next_game(&r, &g);
+    while (pgn_next_move(&r, &g, NULL)) {}
+    mate = g.pos;
+    if (!position_in_check(&mate) || count_legal_moves(&mate) != 0) {
+        printf("FAIL opera game does not end in mate\n");
+        failures++;
+    }
+    return failures;
+}
+
+typedef struct {
+    const char *data;
+    size_t size;
+    size_t games, plies;
+    uint64_t keys;
+} ChunkJob;
+
+static void *read_chunk(void *arg)
+{
+    ChunkJob *job = arg;
+    PgnReader r;
+    PgnGame g;
+    Move m;
+    pgn_open_buffer(&r, job->data, job->size, 0);
+    while (pgn_next_game(&r, &g)) {
+        job->games++;
+        while (pgn_next_move(&r, &g, &m)) {
+            job->plies++;
+            job->keys ^= g.pos.hash;
+        }
+    }
+    return NULL;
+}
+
+static double now_seconds(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/* Reading a large collection in parallel chunks must see the same games,
+ * plies and positions as one sequential pass. */
+static int check_parallel(void)
+{
+    enum { COPIES = 2000, THREADS = 4 };
+    size_t size = (sizeof games - 1) * COPIES;
+    char *big = malloc(size);
+    if (!big) return 1;
+    for (int i = 0; i < COPIES; ++i) memcpy(big + i * (sizeof games - 1), games, sizeof games - 1);
+
+    ChunkJob whole = { big, size, 0, 0, 0 };
+    double t0 = now_seconds();
+    read_chunk(&whole);
+    double seconds = now_seconds() - t0;
+
+    size_t starts[THREADS];
+    size_t chunks = pgn_split(big, size, starts, THREADS);
+    ChunkJob jobs[THREADS];
+    pthread_t threads[THREADS];
+    for (size_t i = 0; i < chunks; ++i) {
+        size_t end = i + 1 < chunks ? starts[i + 1] : size;
+        jobs[i] = (ChunkJob){ big + starts[i], end - starts[i], 0, 0, 0 };
+        pthread_create(&threads[i], NULL, read_chunk, &jobs[i]);
+    }
+    ChunkJob sum = { NULL, 0, 0, 0, 0 };
+    for (size_t i = 0; i < chunks; ++i) {
+        pthread_join(threads[i], NULL);
+        sum.games += jobs[i].games;
+        sum.plies += jobs[i].plies;
+        sum.keys ^= jobs[i].keys;
+    }
+    free(big);
+
+    int ok = chunks == THREADS && sum.games == whole.games && sum.plies == whole.plies && sum.keys == whole.keys &&
+             whole.games == (size_t)COPIES * (sizeof expected / sizeof expected[0]);
+    printf("%s parallel: %zu chunks, %zu games, %zu plies (%.0f plies/s on one thread)\n", ok ? "OK  " : "FAIL",
+           chunks, sum.games, sum.plies, seconds > 0 ? (double)whole.plies / seconds : 0.0);
+    return !ok;
+}
+
+int main(void)
+{
+    int failures = check_san() + check_games() + check_parallel();
+    printf("%s (%d failures)\n", failures ? "pgn tests FAILED" : "pgn tests passed", failures);
+    return failures ? 1 : 0;
+}
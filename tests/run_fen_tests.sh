@@ -11,7 +11,12 @@ if [ ! -x "$BIN" ]; then
   gcc -Iinclude -std=c11 -Wall -Wextra -c tests/fen_roundtrip.c -o build/fen_roundtrip.o || exit 1
   gcc -Iinclude -std=c11 -Wall -Wextra -c src/position.c      -o build/position.o || exit 1
   gcc -Iinclude -std=c11 -Wall -Wextra -c src/position_fen.c  -o build/position_fen.o || exit 1
-  gcc build/fen_roundtrip.o build/position.o build/position_fen.o -o build/fen_roundtrip || exit 1
+  gcc -Iinclude -std=c11 -Wall -Wextra -c src/zobrist.c       -o build/zobrist.o || exit 1
+  gcc -Iinclude -std=c11 -Wall -Wextra -c src/eval.c          -o build/eval.o || exit 1
+  gcc -Iinclude -std=c11 -Wall -Wextra -c src/nnue.c          -o build/nnue.o || exit 1
+  gcc -Iinclude -std=c11 -Wall -Wextra -c src/pawns.c         -o build/pawns.o || exit 1
+  gcc -Iinclude -std=c11 -Wall -Wextra -c src/bitboard.c      -o build/bitboard.o || exit 1
+  gcc build/fen_roundtrip.o build/position.o build/position_fen.o build/zobrist.o build/eval.o build/nnue.o build/pawns.o build/bitboard.o -o build/fen_roundtrip || exit 1
 fi
 
 failures=0
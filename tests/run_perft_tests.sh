@@ -1,36 +1,26 @@
 set -euo pipefail
 
 ROOT="$(cd "$(dirname "$0")/.." && pwd)"
-BIN="$ROOT/build/perft"
-TESTS="$ROOT/tests/perft_tests.txt"
+BIN="$ROOT/build/perft_epd"
+TESTS="${1:-$ROOT/tests/perft_tests.txt}"
 
 if [ ! -x "$BIN" ]; then
-  echo "Building perft binary..."
+  echo "Building perft_epd binary..."
   mkdir -p "$ROOT/build"
-  gcc -Iinclude -std=c11 -Wall -Wextra -O2 src/position.c src/position_fen.c src/movegen.c tests/perft.c -o "$BIN" || exit 1
+  gcc -Iinclude -std=c11 -Wall -Wextra -O2 src/position.c src/position_fen.c src/bitboard.c src/movegen.c src/zobrist.c src/eval.c src/nnue.c src/pawns.c src/perft.c tests/perft_epd.c -pthread -o "$BIN" || exit 1
 fi
 
-failures=0
-while IFS= read -r line || [ -n "$line" ]; do
-  line="${line%%#*}"
-  line="${line#"${line%%[![:space:]]*}"}"
-  line="${line%"${line##*[![:space:]]}"}"
-  [ -z "$line" ] && continue
-
-  IFS=$'\t' read -r fen depth expected <<< "$line"
-  echo -n "Perft: depth=$depth ... "
-  if "$BIN" "$fen" "$depth" "$expected"; then
-    echo "OK"
-  else
-    echo "FAIL"
-    failures=$((failures+1))
-  fi
-done < "$TESTS"
+# PERFT_THREADS=0 uses every online CPU; PERFT_MAX_DEPTH caps deep EPD entries;
+# PERFT_JSON=path writes a machine-readable report.
+args=(-t "${PERFT_THREADS:-0}" -d "${PERFT_MAX_DEPTH:-0}" -H "${PERFT_HASH_MB:-0}")
+if [ -n "${PERFT_JSON:-}" ]; then
+  args+=(-j "$PERFT_JSON")
+fi
 
-if [ $failures -ne 0 ]; then
-  echo "$failures tests failed"
-  exit 1
+if "$BIN" "${args[@]}" "$TESTS"; then
+  echo "All perft tests passed"
+  exit 0
 fi
 
-echo "All perft tests passed"
-exit 0
+echo "perft tests failed"
+exit 1
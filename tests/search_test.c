@@ -0,0 +1,169 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "position.h"
+#include "movegen.h"
+#include "search.h"
+#include "eval.h"
+#include "timeman.h"
+
+typedef struct {
+    const char *fen;
+    int depth;
+    const char *best;     /* expected best move in UCI form, "0000" = no legal move */
+    int mate_in;          /* expected mate distance, 0 = don't check */
+} SearchCase;
+
+static const SearchCase cases[] = {
+    { "6k1/5ppp/8/8/8/8/8/R5K1 w - - 0 1", 4, "a1a8", 1 },
+    { "3qk3/8/8/8/8/8/5PPP/6K1 b - - 0 1", 4, "d8d1", 1 },
+    { "4k3/8/8/3q4/8/8/8/3RK3 w - - 0 1", 3, "d1d5", 0 },
+    { "7k/5Q2/6K1/8/8/8/8/8 b - - 0 1", 3, "0000", 0 },
+    { "k7/8/1K6/8/8/8/8/7R b - - 0 1", 3, "a8b8", 0 },
+};
+
+static int run_cases(TTable *tt, int threads)
+{
+    int failures = 0;
+    for (size_t i = 0; i < sizeof cases / sizeof cases[0]; ++i) {
+        const SearchCase *c = &cases[i];
+        Position pos, before;
+        char err[256];
+        if (position_from_fen(&pos, c->fen, err, sizeof err) != POS_OK) {
+            printf("FAIL %s: %s\n", c->fen, err);
+            failures++;
+            continue;
+        }
+        before = pos;
+        SearchLimits limits;
+        search_limits_init(&limits);
+        limits.depth = c->depth;
+        limits.tt = tt;
+        limits.threads = threads;
+        SearchResult result;
+        char mv[MOVE_UCI_MAX];
+        move_to_uci(search(&pos, &limits, &result), mv);
+
+        int ok = strcmp(mv, c->best) == 0 && memcmp(&pos, &before, sizeof pos) == 0;
+        if (c->mate_in && (!score_is_mate(result.score) || score_mate_in(result.score) != c->mate_in)) ok = 0;
+        if (strcmp(c->best, "0000") == 0 && result.score != 0) ok = 0;
+        printf("%s [tt %d] %s: best %s score %d depth %d nodes %llu\n", ok ? "OK  " : "FAIL", tt ? threads : 0, c->fen,
+               mv, result.score, result.depth, (unsigned long long)result.nodes);
+        if (!ok) failures++;
+    }
+
+    return failures;
+}
+
+/* Kiwipete at depth 6 reaches the same score with the table and far fewer nodes. */
+static int check_tt_saves_nodes(TTable *tt)
+{
+    const char *fen = "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1";
+    Position pos;
+    char err[256];
+    position_from_fen(&pos, fen, err, sizeof err);
+    SearchLimits limits;
+    search_limits_init(&limits);
+    limits.depth = 6;
+    SearchResult plain, hashed;
+    search(&pos, &limits, &plain);
+    tt_clear(tt);
+    limits.tt = tt;
+    search(&pos, &limits, &hashed);
+    int ok = hashed.score == plain.score && hashed.nodes < plain.nodes && hashed.tt_hits > 0;
+    printf("%s tt: score %d/%d nodes %llu -> %llu, hits %llu/%llu\n", ok ? "OK  " : "FAIL",
+           plain.score, hashed.score, (unsigned long long)plain.nodes, (unsigned long long)hashed.nodes,
+           (unsigned long long)hashed.tt_hits, (unsigned long long)hashed.tt_probes);
+    return ok ? 0 : 1;
+}
+
+/* Quiescence alone: win the hanging queen, and decline a pawn defended by a rook.
+ * The expected score is the static eval after the capture (from = -1: standing pat). */
+static int check_quiescence(void)
+{
+    static const struct { const char *fen; int from, to; } cases[] = {
+        { "4k3/8/8/3q4/8/8/8/3RK3 w - - 0 1", SQ_INDEX(3, 0), SQ_INDEX(3, 4) },
+        { "4k3/4r3/8/4p3/8/8/8/4QK2 w - - 0 1", -1, -1 },
+    };
+    int failures = 0;
+    for (size_t i = 0; i < sizeof cases / sizeof cases[0]; ++i) {
+        Position pos;
+        char err[256];
+        position_from_fen(&pos, cases[i].fen, err, sizeof err);
+        int expected = evaluate(&pos);
+        if (cases[i].from >= 0) {
+            MoveUndo undo;
+            make_move(&pos, cases[i].from, cases[i].to, 0, &undo);
+            expected = -evaluate(&pos);
+            unmake_move(&pos, &undo);
+        }
+        uint64_t nodes = 0;
+        int score = search_quiescence(&pos, -SCORE_INFINITE, SCORE_INFINITE, &nodes);
+        int ok = score == expected;
+        printf("%s qsearch %s: %d expected %d (%llu nodes)\n", ok ? "OK  " : "FAIL", cases[i].fen,
+               score, expected, (unsigned long long)nodes);
+        failures += !ok;
+    }
+    return failures;
+}
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec / 1e6;
+}
+
+/* Budgets stay ordered and inside the clock; soft and hard limits end the search in time. */
+static int check_time_management(TTable *tt)
+{
+    static const int64_t clocks[] = { 20, 100, 1000, 10000, 60000, 600000 };
+    static const int64_t incs[] = { 0, 100, 2000 };
+    static const int mtgs[] = { 0, 1, 10, 40 };
+    int failures = 0;
+    for (size_t c = 0; c < sizeof clocks / sizeof clocks[0]; ++c)
+        for (size_t i = 0; i < sizeof incs / sizeof incs[0]; ++i)
+            for (size_t m = 0; m < sizeof mtgs / sizeof mtgs[0]; ++m) {
+                TimeBudget b = time_budget(clocks[c], incs[i], mtgs[m], TIME_DEFAULT_OVERHEAD_MS);
+                int64_t usable = clocks[c] - TIME_DEFAULT_OVERHEAD_MS;
+                if (b.soft_ms < 1 || b.soft_ms > b.hard_ms || (usable > 1 && b.hard_ms >= usable)) {
+                    printf("FAIL time_budget(%lld, %lld, %d): soft %lld hard %lld\n", (long long)clocks[c],
+                           (long long)incs[i], mtgs[m], (long long)b.soft_ms, (long long)b.hard_ms);
+                    failures++;
+                }
+            }
+
+    static const struct { const char *what; int64_t soft_ms, hard_ms; double max_ms; } runs[] = {
+        { "soft limit", 40, 5000, 1000.0 },
+        { "hard limit", 0, 60, 250.0 },
+    };
+    for (size_t r = 0; r < sizeof runs / sizeof runs[0]; ++r) {
+        Position pos;
+        position_from_fen(&pos, "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1", NULL, 0);
+        SearchLimits limits;
+        search_limits_init(&limits);
+        limits.tt = tt;
+        limits.soft_ms = runs[r].soft_ms;
+        limits.movetime_ms = runs[r].hard_ms;
+        SearchResult result;
+        double t0 = now_ms();
+        Move best = search(&pos, &limits, &result);
+        double elapsed = now_ms() - t0;
+        int ok = best != MOVE_NONE && elapsed < runs[r].max_ms;
+        printf("%s %s: depth %d in %.0f ms (soft %lld, hard %lld)\n", ok ? "OK  " : "FAIL", runs[r].what,
+               result.depth, elapsed, (long long)runs[r].soft_ms, (long long)runs[r].hard_ms);
+        failures += !ok;
+    }
+    return failures;
+}
+
+int main(void)
+{
+    TTable *tt = tt_create(8);
+    int failures = run_cases(NULL, 1) + run_cases(tt, 1) + run_cases(tt, 3) + check_tt_saves_nodes(tt) + check_quiescence() +
+                   check_time_management(tt);
+    tt_destroy(tt);
+    printf("%s (%d failures)\n", failures ? "search tests FAILED" : "search tests passed", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,89 @@
+#include <stdio.h>
+#include "position.h"
+#include "movegen.h"
+
+typedef struct {
+    const char *fen;
+    int from, to;
+    int expected;
+} SeeCase;
+
+#define SQ(f, r) SQ_INDEX((f) - 'a', (r) - '1')
+
+static const SeeCase see_cases[] = {
+    { "1k1r4/1pp4p/p7/4p3/8/P5P1/1PP4P/2K1R3 w - - 0 1", SQ('e', '1'), SQ('e', '5'), 100 },
+    { "4k3/8/2p5/3p4/8/8/8/3RK3 w - - 0 1", SQ('d', '1'), SQ('d', '5'), -400 },
+    { "3rk3/8/8/3p4/8/8/3R4/3RK3 w - - 0 1", SQ('d', '2'), SQ('d', '5'), 100 },
+    { "4k3/8/8/3n4/4P3/8/8/4K3 w - - 0 1", SQ('e', '4'), SQ('d', '5'), 320 },
+    { "4k3/8/8/3pP3/8/8/8/4K3 w - d6 0 1", SQ('e', '5'), SQ('d', '6'), 100 },
+};
+
+static const char *tactical_fens[] = {
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    "rnbqkbnr/ppp1pppp/8/3pP3/8/8/PPPP1PPP/RNBQKBNR w KQkq d6 0 3",
+    "4k3/8/8/8/1b6/8/3P4/4K2r w - - 0 1",
+};
+
+static int is_tactical(const Position *pos, Move m)
+{
+    return move_flag(m) == MOVE_FLAG_PROMOTION || move_flag(m) == MOVE_FLAG_EN_PASSANT ||
+           pos->board[move_to(m)] != PIECE_EMPTY;
+}
+
+/* generate_tactical_list must be exactly the captures and promotions of the full legal list. */
+static int check_tactical(const char *fen)
+{
+    Position pos;
+    char err[256];
+    if (position_from_fen(&pos, fen, err, sizeof err) != POS_OK) {
+        printf("FAIL %s: %s\n", fen, err);
+        return 1;
+    }
+    MoveList all, tactical;
+    generate_legal_list(&pos, &all);
+    generate_tactical_list(&pos, &tactical);
+    int expected = 0;
+    for (int i = 0; i < all.count; ++i) {
+        if (!is_tactical(&pos, all.moves[i])) continue;
+        expected++;
+        int found = 0;
+        for (int j = 0; j < tactical.count; ++j) found |= tactical.moves[j] == all.moves[i];
+        if (!found) {
+            printf("FAIL %s: tactical list misses move %d\n", fen, all.moves[i]);
+            return 1;
+        }
+    }
+    if (expected != tactical.count) {
+        printf("FAIL %s: %d tactical moves, expected %d\n", fen, tactical.count, expected);
+        return 1;
+    }
+    printf("OK   %s: %d tactical of %d\n", fen, tactical.count, all.count);
+    return 0;
+}
+
+int main(void)
+{
+    int failures = 0;
+    for (size_t i = 0; i < sizeof tactical_fens / sizeof tactical_fens[0]; ++i)
+        failures += check_tactical(tactical_fens[i]);
+
+    for (size_t i = 0; i < sizeof see_cases / sizeof see_cases[0]; ++i) {
+        const SeeCase *c = &see_cases[i];
+        Position pos;
+        char err[256];
+        if (position_from_fen(&pos, c->fen, err, sizeof err) != POS_OK) {
+            printf("FAIL %s: %s\n", c->fen, err);
+            failures++;
+            continue;
+        }
+        int value = see(&pos, move_from_squares(&pos, c->from, c->to, 0));
+        printf("%s %s: see %d expected %d\n", value == c->expected ? "OK  " : "FAIL", c->fen, value, c->expected);
+        if (value != c->expected) failures++;
+    }
+
+    printf("%s (%d failures)\n", failures ? "see tests FAILED" : "see tests passed", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,146 @@
+#define _POSIX_C_SOURCE 200809L
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "uci.h"
+
+typedef struct {
+    FILE *in, *out;
+    int result;
+} LoopArgs;
+
+static FILE *to_engine, *from_engine;
+
+static void *loop_main(void *arg)
+{
+    LoopArgs *a = arg;
+    a->result = uci_loop(a->in, a->out);
+    fclose(a->out);
+    return NULL;
+}
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec / 1e6;
+}
+
+static void command(const char *text)
+{
+    fprintf(to_engine, "%s\n", text);
+    fflush(to_engine);
+}
+
+/* Read engine output until a line starting with prefix; returns 0 at EOF. */
+static int wait_for(const char *prefix, char *line, size_t size)
+{
+    while (fgets(line, (int)size, from_engine)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (strncmp(line, prefix, strlen(prefix)) == 0) return 1;
+    }
+    return 0;
+}
+
+static int check(int ok, const char *what, const char *line)
+{
+    printf("%s %s: %s\n", ok ? "OK  " : "FAIL", what, line);
+    return !ok;
+}
+
+int main(void)
+{
+    int to_fds[2], from_fds[2];
+    if (pipe(to_fds) != 0 || pipe(from_fds) != 0) return 2;
+    alarm(30);
+    LoopArgs args = { fdopen(to_fds[0], "r"), fdopen(from_fds[1], "w"), -1 };
+    to_engine = fdopen(to_fds[1], "w");
+    from_engine = fdopen(from_fds[0], "r");
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, loop_main, &args) != 0) return 2;
+
+    char line[4096];
+    int failures = 0;
+    command("uci");
+    failures += check(wait_for("uciok", line, sizeof line), "uci handshake", line);
+    command("isready");
+    failures += check(wait_for("readyok", line, sizeof line), "isready", line);
+
+    command("position startpos moves e2e4 e7e5 g1f3 b8c6 f1c4 g8f6 f3g5 d7d5 e4d5");
+    command("go depth 4");
+    failures += check(wait_for("bestmove", line, sizeof line), "go depth after moves", line);
+
+    command("position fen 6k1/5ppp/8/8/8/8/5PPP/R5K1 w - - 0 1");
+    command("go depth 3");
+    failures += check(wait_for("bestmove", line, sizeof line) && strcmp(line, "bestmove a1a8") == 0,
+                      "back-rank mate", line);
+
+    command("position startpos moves e2e5");
+    failures += check(wait_for("info string illegal move e2e5", line, sizeof line), "illegal move", line);
+
+    /* During an infinite search isready and stop must be answered at once. */
+    command("position startpos");
+    command("go infinite");
+    wait_for("info depth 3", line, sizeof line);
+    double t0 = now_ms();
+    command("isready");
+    int ready = wait_for("readyok", line, sizeof line);
+    double ready_ms = now_ms() - t0;
+    char what[64];
+    snprintf(what, sizeof what, "isready while searching (%.1f ms)", ready_ms);
+    failures += check(ready && ready_ms < 50.0, what, line);
+    t0 = now_ms();
+    command("stop");
+    int stopped = wait_for("bestmove", line, sizeof line);
+    double stop_ms = now_ms() - t0;
+    snprintf(what, sizeof what, "stop (%.1f ms)", stop_ms);
+    failures += check(stopped && stop_ms < 100.0, what, line);
+    int moved;
+
+    /* go ponder holds bestmove past its budget until ponderhit, then moves within it. */
+    command("position startpos moves e2e4");
+    command("go ponder wtime 2000 btime 2000 winc 0 binc 0");
+    nanosleep(&(struct timespec){ 0, 600 * 1000 * 1000 }, NULL);
+    command("isready");
+    int early = 0;
+    while (fgets(line, sizeof line, from_engine)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        if (strncmp(line, "bestmove", 8) == 0) early = 1;
+        if (strcmp(line, "readyok") == 0) break;
+    }
+    failures += check(!early, "ponder holds bestmove", line);
+    t0 = now_ms();
+    command("ponderhit");
+    moved = wait_for("bestmove", line, sizeof line);
+    snprintf(what, sizeof what, "ponderhit (%.0f ms)", now_ms() - t0);
+    failures += check(moved && now_ms() - t0 < 1000.0, what, line);
+
+    /* A ponder search that already found mate answers ponderhit at once. */
+    command("position fen 6k1/5ppp/8/8/8/8/5PPP/R5K1 w - - 0 1");
+    command("go ponder wtime 2000 btime 2000");
+    wait_for("info depth 1", line, sizeof line);
+    t0 = now_ms();
+    command("ponderhit");
+    moved = wait_for("bestmove", line, sizeof line);
+    snprintf(what, sizeof what, "ponderhit after mate (%.1f ms)", now_ms() - t0);
+    failures += check(moved && strcmp(line, "bestmove a1a8") == 0 && now_ms() - t0 < 100.0, what, line);
+
+    command("setoption name Hash value 8");
+    command("setoption name Threads value 2");
+    command("ucinewgame");
+    command("position startpos");
+    command("go wtime 2000 btime 2000 winc 0 binc 0");
+    t0 = now_ms();
+    moved = wait_for("bestmove", line, sizeof line);
+    snprintf(what, sizeof what, "go wtime/btime (%.0f ms)", now_ms() - t0);
+    failures += check(moved && now_ms() - t0 < 1000.0, what, line);
+
+    command("quit");
+    pthread_join(thread, NULL);
+    failures += check(args.result == 0, "quit", "");
+
+    printf("%s (%d failures)\n", failures ? "uci tests FAILED" : "uci tests passed", failures);
+    return failures ? 1 : 0;
+}